@@ -0,0 +1,162 @@
+#include "bit-matrix.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+
+using word_block = std::array<word_type, INT_SIZE>;
+
+// In-place transpose of a 64x64 block, where row `i` is word `i` and column `j` is its `j`-th
+// most significant bit (Hacker's Delight, 7-3): swaps off-diagonal sub-blocks of halving size
+void transpose_block(word_block& block) {
+  word_type mask = 0x00000000ffffffff;
+  for (std::size_t width = INT_SIZE / 2; width != 0; width >>= 1, mask ^= mask << width) {
+    for (std::size_t k = 0; k < INT_SIZE; k = ((k | width) + 1) & ~width) {
+      word_type swapped = (block[k] ^ (block[k | width] >> width)) & mask;
+      block[k] ^= swapped;
+      block[k | width] ^= swapped << width;
+    }
+  }
+}
+
+} // namespace
+
+bit_matrix::bit_matrix()
+    : bit_matrix(0, 0, false) {}
+
+bit_matrix::bit_matrix(std::size_t rows, std::size_t cols, bool value)
+    : _rows(rows)
+    , _cols(cols)
+    , _stride((cols + INT_SIZE - 1) / INT_SIZE)
+    , _data(rows * _stride * INT_SIZE, false) {
+  // Padding bits after the last column stay zero, whole-word kernels rely on it
+  if (value) {
+    for (std::size_t i = 0; i < _rows; ++i) {
+      row(i).set();
+    }
+  }
+}
+
+std::size_t bit_matrix::rows() const {
+  return _rows;
+}
+
+std::size_t bit_matrix::cols() const {
+  return _cols;
+}
+
+bool bit_matrix::empty() const {
+  return _rows == 0 || _cols == 0;
+}
+
+bool bit_matrix::test(std::size_t row, std::size_t col) const {
+  assert(row < _rows && col < _cols);
+  return _data.test(row * _stride * INT_SIZE + col);
+}
+
+bit_matrix& bit_matrix::set(std::size_t row, std::size_t col, bool value) {
+  assert(row < _rows && col < _cols);
+  std::size_t pos = row * _stride * INT_SIZE + col;
+  if (value) {
+    _data.set(pos);
+  } else {
+    _data.reset(pos);
+  }
+  return *this;
+}
+
+bit_matrix::view bit_matrix::row(std::size_t index) {
+  assert(index < _rows);
+  return _data.subview(index * _stride * INT_SIZE, _cols);
+}
+
+bit_matrix::const_view bit_matrix::row(std::size_t index) const {
+  assert(index < _rows);
+  return _data.subview(index * _stride * INT_SIZE, _cols);
+}
+
+bitset bit_matrix::column(std::size_t index) const {
+  assert(index < _cols);
+  bitset res(_rows, false);
+  bitset::view out = res;
+  std::size_t word = index / INT_SIZE;
+  std::size_t shift = INT_SIZE - 1 - index % INT_SIZE;
+  for (std::size_t first = 0; first < _rows; first += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, _rows - first);
+    word_type acc = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      acc |= ((load_word(first + i, word) >> shift) & 1) << (INT_SIZE - 1 - i);
+    }
+    out.write_word(first, count, acc);
+  }
+  return res;
+}
+
+std::size_t bit_matrix::row_count(std::size_t index) const {
+  return row(index).count();
+}
+
+std::vector<std::size_t> bit_matrix::and_count(const const_view& vec) const {
+  assert(vec.size() == _cols);
+  std::vector<word_type> vec_words(_stride);
+  for (std::size_t word = 0; word < _stride; ++word) {
+    std::size_t pos = word * INT_SIZE;
+    vec_words[word] = vec.read_word(pos, std::min(INT_SIZE, _cols - pos));
+  }
+
+  std::vector<std::size_t> res(_rows);
+  for (std::size_t i = 0; i < _rows; ++i) {
+    std::size_t count = 0;
+    for (std::size_t word = 0; word < _stride; ++word) {
+      count += std::popcount(load_word(i, word) & vec_words[word]);
+    }
+    res[i] = count;
+  }
+  return res;
+}
+
+bit_matrix bit_matrix::transpose() const {
+  bit_matrix res(_cols, _rows, false);
+  word_block block;
+  // Each 64x64 block is read, transposed in registers and written back once
+  for (std::size_t block_row = 0; block_row * INT_SIZE < _rows; ++block_row) {
+    for (std::size_t block_col = 0; block_col < _stride; ++block_col) {
+      for (std::size_t i = 0; i < INT_SIZE; ++i) {
+        std::size_t src_row = block_row * INT_SIZE + i;
+        block[i] = src_row < _rows ? load_word(src_row, block_col) : 0;
+      }
+      transpose_block(block);
+      for (std::size_t i = 0; i < INT_SIZE; ++i) {
+        std::size_t dst_row = block_col * INT_SIZE + i;
+        if (dst_row < _cols) {
+          res.store_word(dst_row, block_row, block[i]);
+        }
+      }
+    }
+  }
+  return res;
+}
+
+bit_matrix::word_type bit_matrix::load_word(std::size_t row, std::size_t word) const {
+  return _data.subview().read_word((row * _stride + word) * INT_SIZE);
+}
+
+void bit_matrix::store_word(std::size_t row, std::size_t word, word_type value) {
+  _data.subview().write_word((row * _stride + word) * INT_SIZE, INT_SIZE, value);
+}
+
+bool operator==(const bit_matrix& lhs, const bit_matrix& rhs) {
+  return lhs._rows == rhs._rows && lhs._cols == rhs._cols && lhs._data == rhs._data;
+}
+
+bool operator!=(const bit_matrix& lhs, const bit_matrix& rhs) {
+  return !(lhs == rhs);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <vector>
+
+// Dense matrix of bits stored row-major in a single allocation. Every row starts on a word
+// boundary, so rows are exposed as aligned `bitset::view`s.
+class bit_matrix {
+public:
+  using word_type = bitset::word_type;
+
+  using view = bitset::view;
+  using const_view = bitset::const_view;
+
+  bit_matrix();
+  bit_matrix(std::size_t rows, std::size_t cols, bool value);
+
+  std::size_t rows() const;
+  std::size_t cols() const;
+  bool empty() const;
+
+  bool test(std::size_t row, std::size_t col) const;
+  bit_matrix& set(std::size_t row, std::size_t col, bool value);
+
+  view row(std::size_t index);
+  const_view row(std::size_t index) const;
+
+  bitset column(std::size_t index) const;
+
+  std::size_t row_count(std::size_t index) const;
+
+  // `count(row(i) & vec)` for every row `i`
+  std::vector<std::size_t> and_count(const const_view& vec) const;
+
+  bit_matrix transpose() const;
+
+  friend bool operator==(const bit_matrix& lhs, const bit_matrix& rhs);
+
+private:
+  std::size_t _rows;
+  std::size_t _cols;
+  std::size_t _stride;
+  bitset _data;
+
+  word_type load_word(std::size_t row, std::size_t word) const;
+  void store_word(std::size_t row, std::size_t word, word_type value);
+};
+
+bool operator!=(const bit_matrix& lhs, const bit_matrix& rhs);
@@ -0,0 +1,213 @@
+#include "bit-search.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr std::size_t ALPHABET_SIZE = std::numeric_limits<unsigned char>::max() + 1;
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+
+// Unlike `bitset`, pattern vectors are least significant bit first: Myers' algorithm relies
+// on addition carrying towards higher pattern positions, and Shift-And then shifts left.
+std::vector<word_type> build_masks(std::string_view pattern, std::size_t stride) {
+  std::vector<word_type> res(ALPHABET_SIZE * stride, 0);
+  for (std::size_t i = 0; i < pattern.size(); ++i) {
+    std::size_t c = static_cast<unsigned char>(pattern[i]);
+    res[c * stride + i / INT_SIZE] |= word_type(1) << (i % INT_SIZE);
+  }
+  return res;
+}
+
+const word_type* char_mask(const std::vector<word_type>& masks, std::size_t stride, char c) {
+  return masks.data() + static_cast<unsigned char>(c) * stride;
+}
+
+// One column of the Myers recurrence for a block of 64 rows. `hin`/returned value are
+// the horizontal deltas (-1, 0 or +1) entering the top and leaving the `high` row
+int advance_block(word_type& pv, word_type& mv, word_type eq, int hin, word_type high) {
+  word_type xv = eq | mv;
+  if (hin < 0) {
+    eq |= 1;
+  }
+  word_type xh = (((eq & pv) + pv) ^ pv) | eq;
+  word_type ph = mv | ~(xh | pv);
+  word_type mh = pv & xh;
+
+  int hout = 0;
+  if ((ph & high) != 0) {
+    hout = 1;
+  } else if ((mh & high) != 0) {
+    hout = -1;
+  }
+
+  ph <<= 1;
+  mh <<= 1;
+  if (hin < 0) {
+    mh |= 1;
+  } else if (hin > 0) {
+    ph |= 1;
+  }
+  pv = mh | ~(xv | ph);
+  mv = ph & xv;
+  return hout;
+}
+
+} // namespace
+
+// bitap_matcher
+
+bitap_matcher::bitap_matcher(std::string_view pattern)
+    : _size(pattern.size())
+    , _stride((pattern.size() + INT_SIZE - 1) / INT_SIZE)
+    , _masks(build_masks(pattern, _stride)) {
+  assert(!pattern.empty());
+}
+
+std::size_t bitap_matcher::size() const {
+  return _size;
+}
+
+std::vector<std::size_t> bitap_matcher::find_all(std::string_view text) const {
+  std::vector<std::size_t> res;
+  std::vector<word_type> state(_stride, 0);
+  word_type last_bit = word_type(1) << ((_size - 1) % INT_SIZE);
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const word_type* mask = char_mask(_masks, _stride, text[i]);
+    // state = ((state << 1) | 1) & mask in a single pass
+    word_type carry = 1;
+    for (std::size_t word = 0; word < _stride; ++word) {
+      word_type old = state[word];
+      state[word] = ((old << 1) | carry) & mask[word];
+      carry = old >> (INT_SIZE - 1);
+    }
+    if ((state[_stride - 1] & last_bit) != 0) {
+      res.push_back(i + 1);
+    }
+  }
+  return res;
+}
+
+std::vector<std::size_t> bitap_matcher::find_all(std::string_view text, std::size_t max_errors) const {
+  assert(max_errors < _size);
+  if (max_errors == 0) {
+    return find_all(text);
+  }
+
+  std::vector<std::size_t> res;
+  // Row `d` holds the prefixes matched with at most `d` errors; the first `d` of them
+  // match the empty string by deletions
+  std::vector<word_type> state((max_errors + 1) * _stride, 0);
+  for (std::size_t d = 1; d <= max_errors; ++d) {
+    word_type* row = state.data() + d * _stride;
+    for (std::size_t i = 0; i < d; ++i) {
+      row[i / INT_SIZE] |= word_type(1) << (i % INT_SIZE);
+    }
+  }
+  // Previous value of the row above, kept while the current row is rewritten
+  std::vector<word_type> prev_row(_stride);
+  word_type last_bit = word_type(1) << ((_size - 1) % INT_SIZE);
+  const word_type* last_row = state.data() + max_errors * _stride;
+
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const word_type* mask = char_mask(_masks, _stride, text[i]);
+
+    word_type carry = 1;
+    for (std::size_t word = 0; word < _stride; ++word) {
+      word_type old = state[word];
+      prev_row[word] = old;
+      state[word] = ((old << 1) | carry) & mask[word];
+      carry = old >> (INT_SIZE - 1);
+    }
+
+    for (std::size_t d = 1; d <= max_errors; ++d) {
+      word_type* row = state.data() + d * _stride;
+      const word_type* upper = row - _stride;
+      word_type match_carry = 1;
+      word_type edit_carry = 1;
+      for (std::size_t word = 0; word < _stride; ++word) {
+        word_type old = row[word];
+        word_type old_upper = prev_row[word];
+        // Deletion extends the new upper row, substitution the old one
+        word_type edited = old_upper | upper[word];
+        row[word] = (((old << 1) | match_carry) & mask[word]) | old_upper | (edited << 1) | edit_carry;
+        match_carry = old >> (INT_SIZE - 1);
+        edit_carry = edited >> (INT_SIZE - 1);
+        prev_row[word] = old;
+      }
+    }
+
+    if ((last_row[_stride - 1] & last_bit) != 0) {
+      res.push_back(i + 1);
+    }
+  }
+  return res;
+}
+
+// myers_matcher
+
+myers_matcher::myers_matcher(std::string_view pattern)
+    : _size(pattern.size())
+    , _stride((pattern.size() + INT_SIZE - 1) / INT_SIZE)
+    , _masks(build_masks(pattern, _stride)) {
+  assert(!pattern.empty());
+}
+
+std::size_t myers_matcher::size() const {
+  return _size;
+}
+
+std::vector<std::size_t> myers_matcher::find_all(std::string_view text, std::size_t max_errors) const {
+  std::vector<std::size_t> res;
+  std::size_t blocks = _stride;
+  std::size_t last_rows = _size - (blocks - 1) * INT_SIZE;
+  auto rows = [&](std::size_t block) { return block + 1 == blocks ? last_rows : INT_SIZE; };
+  auto high = [&](std::size_t block) { return word_type(1) << (rows(block) - 1); };
+
+  std::vector<word_type> pv(blocks, ALL_ONE);
+  std::vector<word_type> mv(blocks, 0);
+  // Distance at the bottom row of every block for the current column
+  std::vector<std::ptrdiff_t> score(blocks);
+  for (std::size_t block = 0; block < blocks; ++block) {
+    score[block] = static_cast<std::ptrdiff_t>(block * INT_SIZE + rows(block));
+  }
+
+  auto k = static_cast<std::ptrdiff_t>(std::min(max_errors, _size));
+  auto width = static_cast<std::ptrdiff_t>(INT_SIZE);
+  // Blocks after `last` hold only distances above `k` and are not computed (Ukkonen's cut-off)
+  std::size_t last = std::min(blocks, (max_errors / INT_SIZE) + 1) - 1;
+
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const word_type* eq = char_mask(_masks, _stride, text[i]);
+
+    int carry = 0;
+    for (std::size_t block = 0; block <= last; ++block) {
+      carry = advance_block(pv[block], mv[block], eq[block], carry, high(block));
+      score[block] += carry;
+    }
+
+    if (last + 1 < blocks && score[last] - carry <= k && ((eq[last + 1] & 1) != 0 || carry < 0)) {
+      // The next block may have reached `k`: start it from the column where all its
+      // vertical deltas are +1
+      ++last;
+      pv[last] = ALL_ONE;
+      mv[last] = 0;
+      score[last] = score[last - 1] - carry + static_cast<std::ptrdiff_t>(rows(last));
+      score[last] += advance_block(pv[last], mv[last], eq[last], carry, high(last));
+    } else {
+      while (last > 0 && score[last] >= k + width) {
+        --last;
+      }
+    }
+
+    if (last + 1 == blocks && score[last] <= k) {
+      res.push_back(i + 1);
+    }
+  }
+  return res;
+}
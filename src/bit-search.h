@@ -0,0 +1,51 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Bit-parallel pattern matching over byte strings for patterns of any length. The pattern state is
+// a multi-word bit vector where bit `i` corresponds to `pattern[i]`; every text character costs
+// one pass over its words and no allocations.
+//
+// Match positions are reported as the index one past the last character of the occurrence.
+
+// Shift-And (Bitap) with Wu-Manber extension for matches with at most `max_errors` edits
+class bitap_matcher {
+public:
+  using word_type = bitset::word_type;
+
+  explicit bitap_matcher(std::string_view pattern);
+
+  std::size_t size() const;
+
+  std::vector<std::size_t> find_all(std::string_view text) const;
+  // Requires `max_errors < size()`
+  std::vector<std::size_t> find_all(std::string_view text, std::size_t max_errors) const;
+
+private:
+  std::size_t _size;
+  std::size_t _stride;
+  // `_stride` words per byte value
+  std::vector<word_type> _masks;
+};
+
+// Myers' bit-vector algorithm for approximate matching (Levenshtein distance), processing only
+// the blocks of 64 pattern characters that can still contain a cell with distance `<= max_errors`
+class myers_matcher {
+public:
+  using word_type = bitset::word_type;
+
+  explicit myers_matcher(std::string_view pattern);
+
+  std::size_t size() const;
+
+  std::vector<std::size_t> find_all(std::string_view text, std::size_t max_errors) const;
+
+private:
+  std::size_t _size;
+  std::size_t _stride;
+  std::vector<word_type> _masks;
+};
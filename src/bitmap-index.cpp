@@ -0,0 +1,364 @@
+#include "bitmap-index.h"
+
+#include "bitsliced.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace {
+
+std::vector<uint64_t> distinct_keys(std::span<const uint64_t> values) {
+  std::vector<uint64_t> res(values.begin(), values.end());
+  std::sort(res.begin(), res.end());
+  res.erase(std::unique(res.begin(), res.end()), res.end());
+  return res;
+}
+
+std::vector<bitset> equality_bitmaps(std::span<const uint64_t> values, const std::vector<uint64_t>& keys) {
+  std::vector<bitset> res(keys.size(), bitset(values.size(), false));
+  for (std::size_t row = 0; row < values.size(); ++row) {
+    auto key = std::lower_bound(keys.begin(), keys.end(), values[row]);
+    res[key - keys.begin()].set(row);
+  }
+  return res;
+}
+
+// `res |= lhs & ~rhs` in one pass, `nullptr` standing for the empty set
+void or_and_not(bitset& res, const bitset* lhs, const bitset* rhs) {
+  if (lhs == nullptr) {
+    return;
+  }
+  if (rhs == nullptr) {
+    res |= *lhs;
+    return;
+  }
+  for (std::size_t word = 0; word < res.word_count(); ++word) {
+    res.store_word(word, res.load_word(word) | (lhs->load_word(word) & ~rhs->load_word(word)));
+  }
+}
+
+} // namespace
+
+// equality_index
+
+equality_index::equality_index(std::span<const uint64_t> values)
+    : _rows(values.size())
+    , _keys(distinct_keys(values))
+    , _bitmaps(equality_bitmaps(values, _keys)) {}
+
+std::size_t equality_index::rows() const {
+  return _rows;
+}
+
+std::size_t equality_index::cardinality() const {
+  return _keys.size();
+}
+
+bitset equality_index::equal(uint64_t value) const {
+  auto key = std::lower_bound(_keys.begin(), _keys.end(), value);
+  if (key == _keys.end() || *key != value) {
+    return bitset(_rows, false);
+  }
+  return _bitmaps[key - _keys.begin()];
+}
+
+bitset equality_index::less(uint64_t value) const {
+  return any_of(0, std::lower_bound(_keys.begin(), _keys.end(), value) - _keys.begin());
+}
+
+bitset equality_index::between(uint64_t low, uint64_t high) const {
+  if (low > high) {
+    return bitset(_rows, false);
+  }
+  auto first = std::lower_bound(_keys.begin(), _keys.end(), low);
+  auto last = std::upper_bound(first, _keys.end(), high);
+  return any_of(first - _keys.begin(), last - _keys.begin());
+}
+
+bitset equality_index::in(std::span<const uint64_t> values) const {
+  bitset res(_rows, false);
+  for (uint64_t value : distinct_keys(values)) {
+    auto key = std::lower_bound(_keys.begin(), _keys.end(), value);
+    if (key != _keys.end() && *key == value) {
+      res |= _bitmaps[key - _keys.begin()];
+    }
+  }
+  return res;
+}
+
+equality_index::query equality_index::prepare(const predicate& comparison) const {
+  auto key_index = [this](std::vector<uint64_t>::const_iterator key) { return std::size_t(key - _keys.begin()); };
+  std::size_t first_key = 0;
+  std::size_t last_key = 0;
+  switch (comparison.kind) {
+  case predicate::op::equal:
+    first_key = key_index(std::lower_bound(_keys.begin(), _keys.end(), comparison.low));
+    last_key = key_index(std::upper_bound(_keys.begin(), _keys.end(), comparison.low));
+    break;
+  case predicate::op::less:
+    last_key = key_index(std::lower_bound(_keys.begin(), _keys.end(), comparison.low));
+    break;
+  case predicate::op::between:
+    if (comparison.low <= comparison.high) {
+      first_key = key_index(std::lower_bound(_keys.begin(), _keys.end(), comparison.low));
+      last_key = key_index(std::upper_bound(_keys.begin(), _keys.end(), comparison.high));
+    }
+    break;
+  case predicate::op::in: {
+    query res;
+    for (uint64_t value : distinct_keys(comparison.values)) {
+      auto key = std::lower_bound(_keys.begin(), _keys.end(), value);
+      if (key != _keys.end() && *key == value) {
+        res.bitmaps.push_back(&_bitmaps[key_index(key)]);
+      }
+    }
+    return res;
+  }
+  default:
+    assert(false && "not a comparison");
+  }
+  query res;
+  for (std::size_t key = first_key; key < last_key; ++key) {
+    res.bitmaps.push_back(&_bitmaps[key]);
+  }
+  return res;
+}
+
+bitset::word_type equality_index::match_word(const query& q, std::size_t word) const {
+  bitset::word_type res = 0;
+  for (const bitset* bitmap : q.bitmaps) {
+    res |= bitmap->load_word(word);
+  }
+  return res;
+}
+
+bitset equality_index::any_of(std::size_t first_key, std::size_t last_key) const {
+  bitset res(_rows, false);
+  for (std::size_t key = first_key; key < last_key; ++key) {
+    res |= _bitmaps[key];
+  }
+  return res;
+}
+
+// range_index
+
+range_index::range_index(std::span<const uint64_t> values)
+    : _rows(values.size())
+    , _keys(distinct_keys(values))
+    , _bitmaps(equality_bitmaps(values, _keys)) {
+  for (std::size_t key = 1; key < _bitmaps.size(); ++key) {
+    _bitmaps[key] |= _bitmaps[key - 1];
+  }
+}
+
+std::size_t range_index::rows() const {
+  return _rows;
+}
+
+std::size_t range_index::cardinality() const {
+  return _keys.size();
+}
+
+bitset range_index::equal(uint64_t value) const {
+  bitset res(_rows, false);
+  or_and_not(res, at_most(value, true), at_most(value, false));
+  return res;
+}
+
+bitset range_index::less(uint64_t value) const {
+  const bitset* res = at_most(value, false);
+  return res == nullptr ? bitset(_rows, false) : *res;
+}
+
+bitset range_index::between(uint64_t low, uint64_t high) const {
+  bitset res(_rows, false);
+  if (low <= high) {
+    or_and_not(res, at_most(high, true), at_most(low, false));
+  }
+  return res;
+}
+
+bitset range_index::in(std::span<const uint64_t> values) const {
+  bitset res(_rows, false);
+  for (uint64_t value : distinct_keys(values)) {
+    or_and_not(res, at_most(value, true), at_most(value, false));
+  }
+  return res;
+}
+
+range_index::query range_index::prepare(const predicate& comparison) const {
+  query res;
+  switch (comparison.kind) {
+  case predicate::op::equal:
+    res.ranges.emplace_back(at_most(comparison.low, true), at_most(comparison.low, false));
+    break;
+  case predicate::op::less:
+    res.ranges.emplace_back(at_most(comparison.low, false), nullptr);
+    break;
+  case predicate::op::between:
+    if (comparison.low <= comparison.high) {
+      res.ranges.emplace_back(at_most(comparison.high, true), at_most(comparison.low, false));
+    }
+    break;
+  case predicate::op::in:
+    for (uint64_t value : distinct_keys(comparison.values)) {
+      res.ranges.emplace_back(at_most(value, true), at_most(value, false));
+    }
+    break;
+  default:
+    assert(false && "not a comparison");
+  }
+  return res;
+}
+
+bitset::word_type range_index::match_word(const query& q, std::size_t word) const {
+  bitset::word_type res = 0;
+  for (auto [first, second] : q.ranges) {
+    if (first != nullptr) {
+      res |= first->load_word(word) & ~(second == nullptr ? 0 : second->load_word(word));
+    }
+  }
+  return res;
+}
+
+const bitset* range_index::at_most(uint64_t value, bool inclusive) const {
+  auto key = inclusive ? std::upper_bound(_keys.begin(), _keys.end(), value)
+                       : std::lower_bound(_keys.begin(), _keys.end(), value);
+  if (key == _keys.begin()) {
+    return nullptr;
+  }
+  return &_bitmaps[key - _keys.begin() - 1];
+}
+
+// bit_sliced_index
+
+bit_sliced_index::bit_sliced_index(std::span<const uint64_t> values)
+    : _rows(values.size())
+    , _slices(bitsliced_encode(values)) {}
+
+std::size_t bit_sliced_index::rows() const {
+  return _rows;
+}
+
+std::size_t bit_sliced_index::slice_count() const {
+  return _slices.size();
+}
+
+bitset bit_sliced_index::equal(uint64_t value) const {
+  return bitsliced_equal(_slices, value);
+}
+
+bitset bit_sliced_index::less(uint64_t value) const {
+  return bitsliced_less(_slices, value);
+}
+
+bitset bit_sliced_index::between(uint64_t low, uint64_t high) const {
+  return bitsliced_between(_slices, low, high);
+}
+
+bitset bit_sliced_index::in(std::span<const uint64_t> values) const {
+  return bitsliced_in(_slices, distinct_keys(values));
+}
+
+bit_sliced_index::query bit_sliced_index::prepare(const predicate& comparison) const {
+  assert(comparison.operands.empty() && "not a comparison");
+  query res{comparison.kind, comparison.low, comparison.high, {}};
+  if (comparison.kind == predicate::op::in) {
+    res.values = distinct_keys(comparison.values);
+  }
+  return res;
+}
+
+bitset::word_type bit_sliced_index::match_word(const query& q, std::size_t word) const {
+  switch (q.kind) {
+  case predicate::op::equal:
+    return bitsliced_compare_word(_slices, word, q.low).second;
+  case predicate::op::less:
+    return bitsliced_compare_word(_slices, word, q.low).first;
+  case predicate::op::between: {
+    if (q.low > q.high) {
+      return 0;
+    }
+    auto [below_high, equal_high] = bitsliced_compare_word(_slices, word, q.high);
+    return (below_high | equal_high) & ~bitsliced_compare_word(_slices, word, q.low).first;
+  }
+  case predicate::op::in: {
+    bitset::word_type res = 0;
+    for (uint64_t value : q.values) {
+      res |= bitsliced_compare_word(_slices, word, value).second;
+    }
+    return res;
+  }
+  default:
+    assert(false && "not a comparison");
+    return 0;
+  }
+}
+
+// predicate
+
+predicate predicate::equal(uint64_t value) {
+  return {op::equal, value, value, {}, {}};
+}
+
+predicate predicate::less(uint64_t value) {
+  return {op::less, value, value, {}, {}};
+}
+
+predicate predicate::between(uint64_t low, uint64_t high) {
+  return {op::between, low, high, {}, {}};
+}
+
+predicate predicate::in(std::vector<uint64_t> values) {
+  return {op::in, 0, 0, std::move(values), {}};
+}
+
+predicate predicate::conjunction(std::vector<predicate> operands) {
+  return {op::conjunction, 0, 0, {}, std::move(operands)};
+}
+
+predicate predicate::disjunction(std::vector<predicate> operands) {
+  return {op::disjunction, 0, 0, {}, std::move(operands)};
+}
+
+predicate predicate::negation(predicate operand) {
+  std::vector<predicate> operands;
+  operands.push_back(std::move(operand));
+  return {op::negation, 0, 0, {}, std::move(operands)};
+}
+
+// predicate_plan
+
+predicate_plan::predicate_plan(const predicate& pred) {
+  add(pred, 0);
+}
+
+const std::vector<const predicate*>& predicate_plan::leaves() const {
+  return _leaves;
+}
+
+std::size_t predicate_plan::depth() const {
+  return _depth;
+}
+
+void predicate_plan::add(const predicate& pred, std::size_t depth) {
+  switch (pred.kind) {
+  case predicate::op::conjunction:
+  case predicate::op::disjunction:
+    // Operand `i` is pushed on top of the `i` before it
+    for (std::size_t i = 0; i < pred.operands.size(); ++i) {
+      add(pred.operands[i], depth + i);
+    }
+    break;
+  case predicate::op::negation:
+    assert(pred.operands.size() == 1);
+    add(pred.operands[0], depth);
+    break;
+  default:
+    _leaves.push_back(&pred);
+    break;
+  }
+  _steps.push_back({pred.kind, pred.operands.size()});
+  _depth = std::max(_depth, depth + 1);
+}
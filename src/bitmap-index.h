@@ -0,0 +1,215 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Bitmap indexes over a column of unsigned integers. Every query returns the set of matching
+// row ids as a `bitset` of size `rows()`; `between` bounds are inclusive.
+//
+// Besides whole-bitset queries, every index answers a comparison one word of rows at a time:
+// `prepare(comparison)` resolves it to a `query` once, `match_word(query, word)` returns the
+// `word`-th word of its result. `evaluate` combines these words, so a whole predicate tree is
+// computed in one pass without intermediate bitsets.
+
+// Comparisons of the column with constants, combined with `conjunction`, `disjunction` and `negation`
+struct predicate {
+  enum class op : uint8_t {
+    equal,
+    less,
+    between,
+    in,
+    conjunction,
+    disjunction,
+    negation,
+  };
+
+  op kind;
+  uint64_t low = 0;
+  uint64_t high = 0;
+  std::vector<uint64_t> values;
+  // Operands of `conjunction`, `disjunction` and `negation`
+  std::vector<predicate> operands;
+
+  static predicate equal(uint64_t value);
+  static predicate less(uint64_t value);
+  static predicate between(uint64_t low, uint64_t high);
+  static predicate in(std::vector<uint64_t> values);
+  // Empty conjunctions match every row, empty disjunctions none
+  static predicate conjunction(std::vector<predicate> operands);
+  static predicate disjunction(std::vector<predicate> operands);
+  static predicate negation(predicate operand);
+};
+
+// One bitmap per distinct value
+class equality_index {
+public:
+  explicit equality_index(std::span<const uint64_t> values);
+
+  std::size_t rows() const;
+  std::size_t cardinality() const;
+
+  bitset equal(uint64_t value) const;
+  bitset less(uint64_t value) const;
+  bitset between(uint64_t low, uint64_t high) const;
+  bitset in(std::span<const uint64_t> values) const;
+
+  // Bitmaps whose union is the result
+  struct query {
+    std::vector<const bitset*> bitmaps;
+  };
+
+  query prepare(const predicate& comparison) const;
+  bitset::word_type match_word(const query& q, std::size_t word) const;
+
+private:
+  std::size_t _rows;
+  // Sorted distinct values and their bitmaps
+  std::vector<uint64_t> _keys;
+  std::vector<bitset> _bitmaps;
+
+  bitset any_of(std::size_t first_key, std::size_t last_key) const;
+};
+
+// Range encoding: bitmap `i` holds the rows with value `<= keys[i]`, so every range is
+// at most two bitmaps
+class range_index {
+public:
+  explicit range_index(std::span<const uint64_t> values);
+
+  std::size_t rows() const;
+  std::size_t cardinality() const;
+
+  bitset equal(uint64_t value) const;
+  bitset less(uint64_t value) const;
+  bitset between(uint64_t low, uint64_t high) const;
+  bitset in(std::span<const uint64_t> values) const;
+
+  // Union of the rows of `first` that are not in `second`, `nullptr` standing for the empty set
+  struct query {
+    std::vector<std::pair<const bitset*, const bitset*>> ranges;
+  };
+
+  query prepare(const predicate& comparison) const;
+  bitset::word_type match_word(const query& q, std::size_t word) const;
+
+private:
+  std::size_t _rows;
+  std::vector<uint64_t> _keys;
+  std::vector<bitset> _bitmaps;
+
+  // Bitmap of the rows with value `< value` (`<= value` if `inclusive`), `nullptr` if empty
+  const bitset* at_most(uint64_t value, bool inclusive) const;
+};
+
+// Bit-sliced index: slice `i` holds bit `i` of every value. Comparisons with a constant
+// are evaluated word by word over all slices in a single pass.
+class bit_sliced_index {
+public:
+  explicit bit_sliced_index(std::span<const uint64_t> values);
+
+  std::size_t rows() const;
+  std::size_t slice_count() const;
+
+  bitset equal(uint64_t value) const;
+  bitset less(uint64_t value) const;
+  bitset between(uint64_t low, uint64_t high) const;
+  bitset in(std::span<const uint64_t> values) const;
+
+  // The comparison itself, with the `in` values made distinct
+  struct query {
+    predicate::op kind;
+    uint64_t low;
+    uint64_t high;
+    std::vector<uint64_t> values;
+  };
+
+  query prepare(const predicate& comparison) const;
+  bitset::word_type match_word(const query& q, std::size_t word) const;
+
+private:
+  std::size_t _rows;
+  std::vector<bitset> _slices;
+};
+
+// A predicate tree flattened in postfix order: the words of the comparisons (`leaves()`, in
+// order) are pushed on a stack of words and combined by the connectives
+class predicate_plan {
+public:
+  using word_type = bitset::word_type;
+
+  explicit predicate_plan(const predicate& pred);
+
+  const std::vector<const predicate*>& leaves() const;
+  // Stack words needed by `run`
+  std::size_t depth() const;
+
+  // One word of the result; `leaf_word(i)` is the matching word of `leaves()[i]`
+  template <class LeafWord>
+  word_type run(std::span<word_type> stack, LeafWord leaf_word) const {
+    std::size_t top = 0;
+    std::size_t leaf = 0;
+    for (const step& s : _steps) {
+      switch (s.kind) {
+      case predicate::op::conjunction: {
+        word_type res = ~word_type(0);
+        for (std::size_t i = 0; i < s.operands; ++i) {
+          res &= stack[--top];
+        }
+        stack[top++] = res;
+        break;
+      }
+      case predicate::op::disjunction: {
+        word_type res = 0;
+        for (std::size_t i = 0; i < s.operands; ++i) {
+          res |= stack[--top];
+        }
+        stack[top++] = res;
+        break;
+      }
+      case predicate::op::negation:
+        stack[top - 1] = ~stack[top - 1];
+        break;
+      default:
+        stack[top++] = leaf_word(leaf++);
+        break;
+      }
+    }
+    return stack[0];
+  }
+
+private:
+  struct step {
+    predicate::op kind;
+    std::size_t operands;
+  };
+
+  std::vector<step> _steps;
+  std::vector<const predicate*> _leaves;
+  std::size_t _depth = 0;
+
+  void add(const predicate& pred, std::size_t depth);
+};
+
+// Evaluates the whole tree word by word: for every 64 rows the comparisons are read from the
+// index and combined in registers, and only the final word is stored
+template <class Index>
+bitset evaluate(const Index& index, const predicate& pred) {
+  predicate_plan plan(pred);
+  std::vector<typename Index::query> queries;
+  queries.reserve(plan.leaves().size());
+  for (const predicate* leaf : plan.leaves()) {
+    queries.push_back(index.prepare(*leaf));
+  }
+
+  bitset res = bitset::uninitialized(index.rows());
+  std::vector<bitset::word_type> stack(plan.depth());
+  for (std::size_t word = 0; word < res.word_count(); ++word) {
+    res.store_word(word, plan.run(stack, [&](std::size_t leaf) { return index.match_word(queries[leaf], word); }));
+  }
+  return res;
+}
@@ -0,0 +1,402 @@
+#include "bitset-compressed.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+
+// Marker layout: [run value : 1][run length : 31][literal count : 32]
+constexpr std::size_t RUN_LENGTH_SHIFT = 32;
+constexpr word_type MAX_RUN_LENGTH = (word_type(1) << 31) - 1;
+constexpr word_type MAX_LITERALS = (word_type(1) << 32) - 1;
+
+word_type make_marker(bool value, word_type run_length, word_type literals) {
+  return (word_type(value) << (INT_SIZE - 1)) | (run_length << RUN_LENGTH_SHIFT) | literals;
+}
+
+bool marker_value(word_type marker) {
+  return (marker >> (INT_SIZE - 1)) != 0;
+}
+
+word_type marker_run_length(word_type marker) {
+  return (marker >> RUN_LENGTH_SHIFT) & MAX_RUN_LENGTH;
+}
+
+word_type marker_literals(word_type marker) {
+  return marker & MAX_LITERALS;
+}
+
+bool is_clean(word_type word) {
+  return word == 0 || word == ALL_ONE;
+}
+
+} // namespace
+
+// rle_bitset
+
+std::size_t rle_bitset::size() const {
+  return _size;
+}
+
+bool rle_bitset::empty() const {
+  return size() == 0;
+}
+
+std::size_t rle_bitset::count() const {
+  std::size_t res = 0;
+  for (std::size_t i = 1; i < _runs.size(); i += 2) {
+    res += _runs[i];
+  }
+  return res;
+}
+
+const std::vector<std::size_t>& rle_bitset::runs() const {
+  return _runs;
+}
+
+bitset rle_bitset::decode() const {
+  bitset res(size(), false);
+  std::size_t pos = 0;
+  for (std::size_t i = 0; i < _runs.size(); ++i) {
+    if (i % 2 == 1) {
+      res.set(pos, pos + _runs[i], true);
+    }
+    pos += _runs[i];
+  }
+  return res;
+}
+
+void rle_bitset::decode(const bitset::view& out) const {
+  assert(out.size() == size());
+  std::size_t pos = 0;
+  for (std::size_t i = 0; i < _runs.size(); ++i) {
+    if (i % 2 == 1) {
+      out.subview(pos, _runs[i]).set();
+    } else {
+      out.subview(pos, _runs[i]).reset();
+    }
+    pos += _runs[i];
+  }
+}
+
+void rle_bitset::push_run(bool value, std::size_t length) {
+  if (length == 0) {
+    return;
+  }
+  _size += length;
+  if (_runs.empty() && value) {
+    _runs.push_back(0);
+  }
+  bool last_value = _runs.size() % 2 == 0;
+  if (!_runs.empty() && last_value == value) {
+    _runs.back() += length;
+  } else {
+    _runs.push_back(length);
+  }
+}
+
+template <class Function>
+rle_bitset rle_bitset::merge(const rle_bitset& lhs, const rle_bitset& rhs, Function binary_op) {
+  assert(lhs.size() == rhs.size());
+  rle_bitset res;
+  std::size_t i = 0;
+  std::size_t j = 0;
+  std::size_t lhs_left = 0;
+  std::size_t rhs_left = 0;
+  while (true) {
+    while (lhs_left == 0 && i < lhs._runs.size()) {
+      lhs_left = lhs._runs[i++];
+    }
+    while (rhs_left == 0 && j < rhs._runs.size()) {
+      rhs_left = rhs._runs[j++];
+    }
+    if (lhs_left == 0 || rhs_left == 0) {
+      break;
+    }
+    std::size_t length = std::min(lhs_left, rhs_left);
+    res.push_run(binary_op((i - 1) % 2 == 1, (j - 1) % 2 == 1), length);
+    lhs_left -= length;
+    rhs_left -= length;
+  }
+  return res;
+}
+
+rle_bitset operator&(const rle_bitset& lhs, const rle_bitset& rhs) {
+  return rle_bitset::merge(lhs, rhs, [](bool l, bool r) { return l && r; });
+}
+
+rle_bitset operator|(const rle_bitset& lhs, const rle_bitset& rhs) {
+  return rle_bitset::merge(lhs, rhs, [](bool l, bool r) { return l || r; });
+}
+
+rle_bitset operator^(const rle_bitset& lhs, const rle_bitset& rhs) {
+  return rle_bitset::merge(lhs, rhs, [](bool l, bool r) { return l != r; });
+}
+
+rle_bitset encode_rle(const bitset::const_view& bs_view) {
+  rle_bitset res;
+  std::size_t size = bs_view.size();
+  bool value = false;
+  std::size_t run = 0;
+  std::size_t pos = 0;
+  while (pos < size) {
+    std::size_t count = std::min(INT_SIZE, size - pos);
+    word_type word = bs_view.read_word(pos, count);
+    std::size_t same = value ? std::countl_one(word) : std::countl_zero(word);
+    if (same >= count) {
+      run += count;
+      pos += count;
+      continue;
+    }
+    run += same;
+    pos += same;
+    res.push_run(value, run);
+    value = !value;
+    run = 0;
+  }
+  res.push_run(value, run);
+  return res;
+}
+
+// ewah_bitset
+
+class ewah_bitset::cursor {
+public:
+  explicit cursor(const ewah_bitset& bs)
+      : _words(bs._words) {
+    load();
+  }
+
+  bool done() const {
+    return _run_left == 0 && _literals_left == 0;
+  }
+
+  bool in_run() const {
+    return _run_left > 0;
+  }
+
+  word_type run_word() const {
+    return _run_value ? ALL_ONE : 0;
+  }
+
+  std::size_t run_left() const {
+    return _run_left;
+  }
+
+  std::size_t literals_left() const {
+    return _literals_left;
+  }
+
+  word_type literal(std::size_t index) const {
+    return _words[_pos + index];
+  }
+
+  void skip_run(std::size_t count) {
+    _run_left -= count;
+    load();
+  }
+
+  void skip_literals(std::size_t count) {
+    _pos += count;
+    _literals_left -= count;
+    load();
+  }
+
+private:
+  const std::vector<word_type>& _words;
+  std::size_t _next = 0;
+  std::size_t _pos = 0;
+  bool _run_value = false;
+  std::size_t _run_left = 0;
+  std::size_t _literals_left = 0;
+
+  void load() {
+    while (done() && _next < _words.size()) {
+      word_type marker = _words[_next];
+      _run_value = marker_value(marker);
+      _run_left = marker_run_length(marker);
+      _literals_left = marker_literals(marker);
+      _pos = _next + 1;
+      _next = _pos + _literals_left;
+    }
+  }
+};
+
+std::size_t ewah_bitset::size() const {
+  return _size;
+}
+
+bool ewah_bitset::empty() const {
+  return size() == 0;
+}
+
+std::size_t ewah_bitset::count() const {
+  std::size_t res = 0;
+  for_each_chunk(
+      [&res](std::size_t, std::size_t length, bool value) {
+        if (value) {
+          res += length * INT_SIZE;
+        }
+      },
+      [&res](std::size_t, word_type word) { res += std::popcount(word); }
+  );
+  return res;
+}
+
+const std::vector<ewah_bitset::word_type>& ewah_bitset::words() const {
+  return _words;
+}
+
+bitset ewah_bitset::decode() const {
+  bitset res(size(), false);
+  bitset::view out = res;
+  for_each_chunk(
+      [&res, this](std::size_t word, std::size_t length, bool value) {
+        if (value) {
+          res.set(word * INT_SIZE, std::min((word + length) * INT_SIZE, size()), true);
+        }
+      },
+      [&out, this](std::size_t word, word_type literal) {
+        out.write_word(word * INT_SIZE, std::min(INT_SIZE, size() - word * INT_SIZE), literal);
+      }
+  );
+  return res;
+}
+
+void ewah_bitset::decode(const bitset::view& out) const {
+  assert(out.size() == size());
+  for_each_chunk(
+      [&out, this](std::size_t word, std::size_t length, bool value) {
+        std::size_t first = word * INT_SIZE;
+        bitset::view run = out.subview(first, std::min(length * INT_SIZE, size() - first));
+        if (value) {
+          run.set();
+        } else {
+          run.reset();
+        }
+      },
+      [&out, this](std::size_t word, word_type literal) {
+        out.write_word(word * INT_SIZE, std::min(INT_SIZE, size() - word * INT_SIZE), literal);
+      }
+  );
+}
+
+void ewah_bitset::push_run(bool value, std::size_t length) {
+  while (length > 0) {
+    bool extendable = false;
+    if (!_words.empty()) {
+      word_type marker = _words[_marker];
+      extendable = marker_literals(marker) == 0 && marker_run_length(marker) < MAX_RUN_LENGTH &&
+                   (marker_run_length(marker) == 0 || marker_value(marker) == value);
+    }
+    if (!extendable) {
+      _marker = _words.size();
+      _words.push_back(make_marker(value, 0, 0));
+    }
+    word_type run_length = marker_run_length(_words[_marker]);
+    std::size_t added = std::min<std::size_t>(length, MAX_RUN_LENGTH - run_length);
+    _words[_marker] = make_marker(value, run_length + added, 0);
+    length -= added;
+  }
+}
+
+void ewah_bitset::push_word(word_type word) {
+  if (is_clean(word)) {
+    push_run(word != 0, 1);
+    return;
+  }
+  if (_words.empty() || marker_literals(_words[_marker]) == MAX_LITERALS) {
+    _marker = _words.size();
+    _words.push_back(make_marker(false, 0, 0));
+  }
+  ++_words[_marker];
+  _words.push_back(word);
+}
+
+template <class RunFunction, class LiteralFunction>
+void ewah_bitset::for_each_chunk(RunFunction run_function, LiteralFunction literal_function) const {
+  std::size_t word = 0;
+  std::size_t i = 0;
+  while (i < _words.size()) {
+    word_type marker = _words[i];
+    std::size_t run_length = marker_run_length(marker);
+    std::size_t literals = marker_literals(marker);
+    if (run_length > 0) {
+      run_function(word, run_length, marker_value(marker));
+      word += run_length;
+    }
+    for (std::size_t k = 1; k <= literals; ++k) {
+      literal_function(word++, _words[i + k]);
+    }
+    i += literals + 1;
+  }
+}
+
+template <class Function>
+ewah_bitset ewah_bitset::merge(const ewah_bitset& lhs, const ewah_bitset& rhs, Function binary_op) {
+  assert(lhs.size() == rhs.size());
+  ewah_bitset res;
+  cursor lhs_cursor(lhs);
+  cursor rhs_cursor(rhs);
+  while (!lhs_cursor.done() && !rhs_cursor.done()) {
+    if (lhs_cursor.in_run() && rhs_cursor.in_run()) {
+      std::size_t length = std::min(lhs_cursor.run_left(), rhs_cursor.run_left());
+      res.push_run(binary_op(lhs_cursor.run_word(), rhs_cursor.run_word()) != 0, length);
+      lhs_cursor.skip_run(length);
+      rhs_cursor.skip_run(length);
+    } else if (lhs_cursor.in_run() || rhs_cursor.in_run()) {
+      cursor& run = lhs_cursor.in_run() ? lhs_cursor : rhs_cursor;
+      cursor& literals = lhs_cursor.in_run() ? rhs_cursor : lhs_cursor;
+      std::size_t length = std::min(run.run_left(), literals.literals_left());
+      word_type run_word = run.run_word();
+      if (binary_op(run_word, 0) == binary_op(run_word, ALL_ONE)) {
+        // The run absorbs the literals, e.g. AND with zeros
+        res.push_run(binary_op(run_word, 0) != 0, length);
+      } else {
+        for (std::size_t k = 0; k < length; ++k) {
+          res.push_word(binary_op(run_word, literals.literal(k)));
+        }
+      }
+      run.skip_run(length);
+      literals.skip_literals(length);
+    } else {
+      std::size_t length = std::min(lhs_cursor.literals_left(), rhs_cursor.literals_left());
+      for (std::size_t k = 0; k < length; ++k) {
+        res.push_word(binary_op(lhs_cursor.literal(k), rhs_cursor.literal(k)));
+      }
+      lhs_cursor.skip_literals(length);
+      rhs_cursor.skip_literals(length);
+    }
+  }
+  res._size = lhs.size();
+  return res;
+}
+
+ewah_bitset operator&(const ewah_bitset& lhs, const ewah_bitset& rhs) {
+  return ewah_bitset::merge(lhs, rhs, [](word_type l, word_type r) { return l & r; });
+}
+
+ewah_bitset operator|(const ewah_bitset& lhs, const ewah_bitset& rhs) {
+  return ewah_bitset::merge(lhs, rhs, [](word_type l, word_type r) { return l | r; });
+}
+
+ewah_bitset operator^(const ewah_bitset& lhs, const ewah_bitset& rhs) {
+  return ewah_bitset::merge(lhs, rhs, [](word_type l, word_type r) { return l ^ r; });
+}
+
+ewah_bitset encode_ewah(const bitset::const_view& bs_view) {
+  ewah_bitset res;
+  std::size_t size = bs_view.size();
+  for (std::size_t pos = 0; pos < size; pos += INT_SIZE) {
+    res.push_word(bs_view.read_word(pos, std::min(INT_SIZE, size - pos)));
+  }
+  res._size = size;
+  return res;
+}
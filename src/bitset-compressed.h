@@ -0,0 +1,85 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <vector>
+
+// Run-length encoding: lengths of alternating runs, the first run consists of zeros (and may be empty)
+class rle_bitset {
+public:
+  using word_type = bitset::word_type;
+
+  rle_bitset() = default;
+
+  std::size_t size() const;
+  bool empty() const;
+  std::size_t count() const;
+
+  const std::vector<std::size_t>& runs() const;
+
+  bitset decode() const;
+  void decode(const bitset::view& out) const;
+
+  friend rle_bitset operator&(const rle_bitset& lhs, const rle_bitset& rhs);
+  friend rle_bitset operator|(const rle_bitset& lhs, const rle_bitset& rhs);
+  friend rle_bitset operator^(const rle_bitset& lhs, const rle_bitset& rhs);
+
+  friend bool operator==(const rle_bitset& lhs, const rle_bitset& rhs) = default;
+
+  friend rle_bitset encode_rle(const bitset::const_view& bs_view);
+
+private:
+  std::size_t _size = 0;
+  std::vector<std::size_t> _runs;
+
+  void push_run(bool value, std::size_t length);
+
+  template <class Function>
+  static rle_bitset merge(const rle_bitset& lhs, const rle_bitset& rhs, Function binary_op);
+};
+
+// EWAH: each marker word holds the value and length of a run of clean (all-zero or all-one) words
+// and the number of literal words stored right after it
+class ewah_bitset {
+public:
+  using word_type = bitset::word_type;
+
+  ewah_bitset() = default;
+
+  std::size_t size() const;
+  bool empty() const;
+  std::size_t count() const;
+
+  const std::vector<word_type>& words() const;
+
+  bitset decode() const;
+  void decode(const bitset::view& out) const;
+
+  friend ewah_bitset operator&(const ewah_bitset& lhs, const ewah_bitset& rhs);
+  friend ewah_bitset operator|(const ewah_bitset& lhs, const ewah_bitset& rhs);
+  friend ewah_bitset operator^(const ewah_bitset& lhs, const ewah_bitset& rhs);
+
+  friend bool operator==(const ewah_bitset& lhs, const ewah_bitset& rhs) = default;
+
+  friend ewah_bitset encode_ewah(const bitset::const_view& bs_view);
+
+private:
+  std::size_t _size = 0;
+  std::vector<word_type> _words;
+  std::size_t _marker = 0;
+
+  class cursor;
+
+  void push_run(bool value, std::size_t length);
+  void push_word(word_type word);
+
+  template <class Function>
+  static ewah_bitset merge(const ewah_bitset& lhs, const ewah_bitset& rhs, Function binary_op);
+
+  template <class RunFunction, class LiteralFunction>
+  void for_each_chunk(RunFunction run_function, LiteralFunction literal_function) const;
+};
+
+rle_bitset encode_rle(const bitset::const_view& bs_view);
+ewah_bitset encode_ewah(const bitset::const_view& bs_view);
@@ -0,0 +1,316 @@
+#include "bitset-delta.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr std::size_t BLOCK_WORDS = tracked_bitset::BLOCK_SIZE / INT_SIZE;
+
+void write_varint(std::vector<std::byte>& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<std::byte>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<std::byte>(value));
+}
+
+void write_word(std::vector<std::byte>& out, word_type value) {
+  for (std::size_t i = 0; i < sizeof(word_type); ++i) {
+    out.push_back(static_cast<std::byte>(value >> (8 * i)));
+  }
+}
+
+class byte_reader {
+public:
+  explicit byte_reader(std::span<const std::byte> bytes)
+      : _bytes(bytes) {}
+
+  uint64_t read_varint() {
+    uint64_t res = 0;
+    for (std::size_t shift = 0; shift < 64; shift += 7) {
+      uint64_t byte = std::to_integer<uint64_t>(next());
+      res |= (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return res;
+      }
+    }
+    throw std::invalid_argument("bitset_delta: malformed varint");
+  }
+
+  word_type read_word() {
+    word_type res = 0;
+    for (std::size_t i = 0; i < sizeof(word_type); ++i) {
+      res |= std::to_integer<word_type>(next()) << (8 * i);
+    }
+    return res;
+  }
+
+  bool done() const {
+    return _pos == _bytes.size();
+  }
+
+private:
+  std::span<const std::byte> _bytes;
+  std::size_t _pos = 0;
+
+  std::byte next() {
+    if (_pos == _bytes.size()) {
+      throw std::invalid_argument("bitset_delta: truncated input");
+    }
+    return _bytes[_pos++];
+  }
+};
+
+} // namespace
+
+// bitset_delta
+
+bitset_delta::bitset_delta(std::size_t size, mode patch_mode)
+    : _size(size)
+    , _mode(patch_mode) {}
+
+std::size_t bitset_delta::size() const {
+  return _size;
+}
+
+bitset_delta::mode bitset_delta::patch_mode() const {
+  return _mode;
+}
+
+bool bitset_delta::empty() const {
+  return _runs.empty();
+}
+
+const std::vector<bitset_delta::run>& bitset_delta::runs() const {
+  return _runs;
+}
+
+const std::vector<bitset_delta::word_type>& bitset_delta::words() const {
+  return _words;
+}
+
+void bitset_delta::append(std::size_t word, word_type value) {
+  assert(word * INT_SIZE < size());
+  assert(_runs.empty() || _runs.back().first_word + _runs.back().length <= word);
+  if (!_runs.empty() && _runs.back().first_word + _runs.back().length == word) {
+    ++_runs.back().length;
+  } else {
+    _runs.push_back({word, 1});
+  }
+  _words.push_back(value);
+}
+
+std::vector<std::byte> bitset_delta::serialize() const {
+  std::vector<std::byte> res;
+  res.reserve(16 + _runs.size() * 4 + _words.size() * sizeof(word_type));
+  write_varint(res, _size);
+  write_varint(res, static_cast<uint64_t>(_mode));
+  write_varint(res, _runs.size());
+
+  std::size_t next_word = 0;
+  auto words = _words.begin();
+  for (const run& r : _runs) {
+    // Runs are sorted, so gaps are smaller than absolute positions
+    write_varint(res, r.first_word - next_word);
+    write_varint(res, r.length);
+    for (std::size_t i = 0; i < r.length; ++i) {
+      write_word(res, *words++);
+    }
+    next_word = r.first_word + r.length;
+  }
+  return res;
+}
+
+bitset_delta bitset_delta::deserialize(std::span<const std::byte> bytes) {
+  byte_reader reader(bytes);
+  std::size_t size = reader.read_varint();
+  uint64_t patch_mode = reader.read_varint();
+  if (patch_mode > static_cast<uint64_t>(mode::exclusive_or)) {
+    throw std::invalid_argument("bitset_delta: unknown mode");
+  }
+  bitset_delta res(size, static_cast<mode>(patch_mode));
+
+  std::size_t words = (size + INT_SIZE - 1) / INT_SIZE;
+  std::size_t runs = reader.read_varint();
+  std::size_t next_word = 0;
+  for (std::size_t i = 0; i < runs; ++i) {
+    std::size_t first_word = next_word + reader.read_varint();
+    std::size_t length = reader.read_varint();
+    if (first_word < next_word || length == 0 || length > words || first_word > words - length) {
+      throw std::invalid_argument("bitset_delta: run out of range");
+    }
+    res._runs.push_back({first_word, length});
+    for (std::size_t k = 0; k < length; ++k) {
+      res._words.push_back(reader.read_word());
+    }
+    next_word = first_word + length;
+  }
+  if (!reader.done()) {
+    throw std::invalid_argument("bitset_delta: trailing bytes");
+  }
+  return res;
+}
+
+bitset_delta diff(const bitset::const_view& from, const bitset::const_view& to) {
+  assert(from.size() == to.size());
+  bitset_delta res(from.size(), bitset_delta::mode::exclusive_or);
+  std::size_t words = from.word_count();
+  for (std::size_t word = 0; word < words; ++word) {
+    word_type change = from.load_word(word) ^ to.load_word(word);
+    if (change != 0) {
+      res.append(word, change);
+    }
+  }
+  return res;
+}
+
+void apply_delta(const bitset::view& target, const bitset_delta& delta) {
+  assert(target.size() == delta.size());
+  auto words = delta.words().begin();
+  for (const bitset_delta::run& r : delta.runs()) {
+    for (std::size_t word = r.first_word; word < r.first_word + r.length; ++word) {
+      word_type value = *words++;
+      if (delta.patch_mode() == bitset_delta::mode::exclusive_or) {
+        value ^= target.load_word(word);
+      }
+      target.store_word(word, value);
+    }
+  }
+}
+
+// tracked_bitset
+
+tracked_bitset::tracked_bitset(std::size_t size, bool value)
+    : _bits(size, value)
+    , _dirty((size + BLOCK_SIZE - 1) / BLOCK_SIZE, false) {}
+
+tracked_bitset::tracked_bitset(const const_view& other)
+    : _bits(other)
+    , _dirty((other.size() + BLOCK_SIZE - 1) / BLOCK_SIZE, false) {}
+
+std::size_t tracked_bitset::size() const {
+  return _bits.size();
+}
+
+bool tracked_bitset::empty() const {
+  return size() == 0;
+}
+
+bool tracked_bitset::test(std::size_t pos) const {
+  return _bits.test(pos);
+}
+
+tracked_bitset& tracked_bitset::set(std::size_t pos) {
+  _bits.set(pos);
+  _dirty.set(pos / BLOCK_SIZE);
+  return *this;
+}
+
+tracked_bitset& tracked_bitset::reset(std::size_t pos) {
+  _bits.reset(pos);
+  _dirty.set(pos / BLOCK_SIZE);
+  return *this;
+}
+
+tracked_bitset& tracked_bitset::flip(std::size_t pos) {
+  _bits.flip(pos);
+  _dirty.set(pos / BLOCK_SIZE);
+  return *this;
+}
+
+tracked_bitset& tracked_bitset::set(std::size_t first, std::size_t last, bool value) {
+  _bits.set(first, last, value);
+  mark(first, last);
+  return *this;
+}
+
+tracked_bitset& tracked_bitset::flip(std::size_t first, std::size_t last) {
+  _bits.flip(first, last);
+  mark(first, last);
+  return *this;
+}
+
+template <class Function>
+tracked_bitset& tracked_bitset::apply_blocks(const const_view& other, Function binary_op) {
+  assert(size() == other.size());
+  // Only blocks whose words actually change become dirty
+  std::array<word_type, BLOCK_WORDS> before;
+  std::size_t words = _bits.word_count();
+  for (std::size_t block = 0; block < _dirty.size(); ++block) {
+    std::size_t first_word = block * BLOCK_WORDS;
+    std::size_t block_words = std::min(BLOCK_WORDS, words - first_word);
+    for (std::size_t i = 0; i < block_words; ++i) {
+      before[i] = _bits.load_word(first_word + i);
+    }
+    binary_op(_bits.subview(block * BLOCK_SIZE, BLOCK_SIZE), other.subview(block * BLOCK_SIZE, BLOCK_SIZE));
+    for (std::size_t i = 0; i < block_words; ++i) {
+      if (before[i] != _bits.load_word(first_word + i)) {
+        _dirty.set(block);
+        break;
+      }
+    }
+  }
+  return *this;
+}
+
+tracked_bitset& tracked_bitset::operator&=(const const_view& other) {
+  return apply_blocks(other, [](const view& lhs, const const_view& rhs) { lhs &= rhs; });
+}
+
+tracked_bitset& tracked_bitset::operator|=(const const_view& other) {
+  return apply_blocks(other, [](const view& lhs, const const_view& rhs) { lhs |= rhs; });
+}
+
+tracked_bitset& tracked_bitset::operator^=(const const_view& other) {
+  return apply_blocks(other, [](const view& lhs, const const_view& rhs) { lhs ^= rhs; });
+}
+
+bitset_delta tracked_bitset::export_delta() {
+  bitset_delta res(size(), bitset_delta::mode::replace);
+  std::size_t words = _bits.word_count();
+  for (std::size_t block = _dirty.find_first(); block != bitset::npos; block = _dirty.find_next(block + 1)) {
+    std::size_t first_word = block * BLOCK_WORDS;
+    for (std::size_t word = first_word; word < std::min(first_word + BLOCK_WORDS, words); ++word) {
+      res.append(word, _bits.load_word(word));
+    }
+  }
+  clear_dirty();
+  return res;
+}
+
+tracked_bitset& tracked_bitset::apply_delta(const bitset_delta& delta) {
+  ::apply_delta(_bits, delta);
+  for (const bitset_delta::run& r : delta.runs()) {
+    mark(r.first_word * INT_SIZE, std::min((r.first_word + r.length) * INT_SIZE, size()));
+  }
+  return *this;
+}
+
+std::size_t tracked_bitset::dirty_blocks() const {
+  return _dirty.count();
+}
+
+void tracked_bitset::clear_dirty() {
+  _dirty.reset();
+}
+
+const bitset& tracked_bitset::bits() const {
+  return _bits;
+}
+
+tracked_bitset::operator const_view() const {
+  return _bits;
+}
+
+void tracked_bitset::mark(std::size_t first, std::size_t last) {
+  if (first < last) {
+    _dirty.set(first / BLOCK_SIZE, (last - 1) / BLOCK_SIZE + 1, true);
+  }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Word-level patch: runs of consecutive words, each either replacing the target words
+// or to be XOR-ed into them
+class bitset_delta {
+public:
+  using word_type = bitset::word_type;
+
+  enum class mode : uint8_t {
+    replace,
+    exclusive_or,
+  };
+
+  struct run {
+    std::size_t first_word;
+    std::size_t length;
+
+    friend bool operator==(const run& lhs, const run& rhs) = default;
+  };
+
+  bitset_delta() = default;
+  bitset_delta(std::size_t size, mode patch_mode);
+
+  // Size in bits of the bitset the delta applies to
+  std::size_t size() const;
+  mode patch_mode() const;
+  bool empty() const;
+
+  const std::vector<run>& runs() const;
+  const std::vector<word_type>& words() const;
+
+  void append(std::size_t word, word_type value);
+
+  // Binary format: LEB128 varints for the header and run positions, little-endian words
+  std::vector<std::byte> serialize() const;
+  static bitset_delta deserialize(std::span<const std::byte> bytes);
+
+  friend bool operator==(const bitset_delta& lhs, const bitset_delta& rhs) = default;
+
+private:
+  std::size_t _size = 0;
+  mode _mode = mode::replace;
+  std::vector<run> _runs;
+  std::vector<word_type> _words;
+};
+
+// XOR delta turning `from` into `to`: only the non-zero words of `from ^ to`
+bitset_delta diff(const bitset::const_view& from, const bitset::const_view& to);
+
+void apply_delta(const bitset::view& target, const bitset_delta& delta);
+
+// Bitset that remembers which blocks of `BLOCK_SIZE` bits were modified since the last export
+class tracked_bitset {
+public:
+  using word_type = bitset::word_type;
+
+  using view = bitset::view;
+  using const_view = bitset::const_view;
+
+  // One cache line of bits
+  static constexpr std::size_t BLOCK_SIZE = 512;
+
+  tracked_bitset(std::size_t size, bool value);
+  explicit tracked_bitset(const const_view& other);
+
+  std::size_t size() const;
+  bool empty() const;
+
+  bool test(std::size_t pos) const;
+  tracked_bitset& set(std::size_t pos);
+  tracked_bitset& reset(std::size_t pos);
+  tracked_bitset& flip(std::size_t pos);
+
+  tracked_bitset& set(std::size_t first, std::size_t last, bool value);
+  tracked_bitset& flip(std::size_t first, std::size_t last);
+
+  tracked_bitset& operator&=(const const_view& other);
+  tracked_bitset& operator|=(const const_view& other);
+  tracked_bitset& operator^=(const const_view& other);
+
+  // Current values of the dirty blocks; clears the dirty state
+  bitset_delta export_delta();
+  tracked_bitset& apply_delta(const bitset_delta& delta);
+
+  std::size_t dirty_blocks() const;
+  void clear_dirty();
+
+  const bitset& bits() const;
+  operator const_view() const;
+
+private:
+  bitset _bits;
+  bitset _dirty;
+
+  void mark(std::size_t first, std::size_t last);
+
+  template <class Function>
+  tracked_bitset& apply_blocks(const const_view& other, Function binary_op);
+};
@@ -0,0 +1,183 @@
+#include "bitset-gather.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define BITSET_BMI2_DISPATCH
+#define BITSET_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define BITSET_ALWAYS_INLINE inline
+#endif
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+
+word_type lowest_bit(word_type num) {
+  return num & (~num + 1);
+}
+
+struct portable_bits {
+  static word_type pext(word_type source, word_type mask) {
+    word_type res = 0;
+    for (word_type bit = 1; mask != 0; bit <<= 1) {
+      if ((source & lowest_bit(mask)) != 0) {
+        res |= bit;
+      }
+      mask &= mask - 1;
+    }
+    return res;
+  }
+
+  static word_type pdep(word_type source, word_type mask) {
+    word_type res = 0;
+    for (word_type bit = 1; mask != 0; bit <<= 1) {
+      if ((source & bit) != 0) {
+        res |= lowest_bit(mask);
+      }
+      mask &= mask - 1;
+    }
+    return res;
+  }
+};
+
+#ifdef BITSET_BMI2_DISPATCH
+struct bmi2_bits {
+  __attribute__((target("bmi2"))) static word_type pext(word_type source, word_type mask) {
+    return _pext_u64(source, mask);
+  }
+
+  __attribute__((target("bmi2"))) static word_type pdep(word_type source, word_type mask) {
+    return _pdep_u64(source, mask);
+  }
+};
+
+bool has_bmi2() {
+  static const bool res = __builtin_cpu_supports("bmi2");
+  return res;
+}
+#endif
+
+// Appends bit groups to a bitset, writing only whole words until the final flush
+class word_writer {
+public:
+  explicit word_writer(const bitset::view& out)
+      : _out(out) {}
+
+  // `bits` holds `count` bits in its high part
+  void push(word_type bits, std::size_t count) {
+    _acc |= bits >> _filled;
+    if (_filled + count < INT_SIZE) {
+      _filled += count;
+      return;
+    }
+    _out.write_word(_pos, INT_SIZE, _acc);
+    _pos += INT_SIZE;
+    std::size_t used = INT_SIZE - _filled;
+    _acc = (used < INT_SIZE) ? bits << used : 0;
+    _filled = _filled + count - INT_SIZE;
+  }
+
+  void flush() {
+    _out.write_word(_pos, _filled, _acc);
+  }
+
+private:
+  bitset::view _out;
+  std::size_t _pos = 0;
+  word_type _acc = 0;
+  std::size_t _filled = 0;
+};
+
+template <class Bits>
+BITSET_ALWAYS_INLINE void extract_words(
+    const bitset::const_view& source,
+    const bitset::const_view& mask,
+    const bitset::view& out
+) {
+  word_writer writer(out);
+  for (std::size_t pos = 0; pos < mask.size(); pos += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, mask.size() - pos);
+    word_type mask_word = mask.read_word(pos, count);
+    if (mask_word == 0) {
+      continue;
+    }
+    std::size_t selected = std::popcount(mask_word);
+    word_type bits = Bits::pext(source.read_word(pos, count), mask_word);
+    writer.push(bits << (INT_SIZE - selected), selected);
+  }
+  writer.flush();
+}
+
+template <class Bits>
+BITSET_ALWAYS_INLINE void deposit_words(
+    const bitset::const_view& dense,
+    const bitset::const_view& mask,
+    const bitset::view& out
+) {
+  std::size_t dense_pos = 0;
+  for (std::size_t pos = 0; pos < mask.size(); pos += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, mask.size() - pos);
+    word_type mask_word = mask.read_word(pos, count);
+    if (mask_word == 0) {
+      continue;
+    }
+    std::size_t selected = std::popcount(mask_word);
+    word_type bits = dense.read_word(dense_pos, selected) >> (INT_SIZE - selected);
+    dense_pos += selected;
+    out.write_word(pos, count, Bits::pdep(bits, mask_word));
+  }
+}
+
+#ifdef BITSET_BMI2_DISPATCH
+__attribute__((target("bmi2"))) void extract_words_bmi2(
+    const bitset::const_view& source,
+    const bitset::const_view& mask,
+    const bitset::view& out
+) {
+  extract_words<bmi2_bits>(source, mask, out);
+}
+
+__attribute__((target("bmi2"))) void deposit_words_bmi2(
+    const bitset::const_view& dense,
+    const bitset::const_view& mask,
+    const bitset::view& out
+) {
+  deposit_words<bmi2_bits>(dense, mask, out);
+}
+#endif
+
+} // namespace
+
+bitset extract(const bitset::const_view& source, const bitset::const_view& mask) {
+  assert(source.size() == mask.size());
+  // The writer stores every bit of the result
+  bitset res = bitset::uninitialized(mask.count());
+#ifdef BITSET_BMI2_DISPATCH
+  if (has_bmi2()) {
+    extract_words_bmi2(source, mask, res);
+    return res;
+  }
+#endif
+  extract_words<portable_bits>(source, mask, res);
+  return res;
+}
+
+bitset deposit(const bitset::const_view& dense, const bitset::const_view& mask) {
+  assert(dense.size() >= mask.count());
+  bitset res(mask.size(), false);
+#ifdef BITSET_BMI2_DISPATCH
+  if (has_bmi2()) {
+    deposit_words_bmi2(dense, mask, res);
+    return res;
+  }
+#endif
+  deposit_words<portable_bits>(dense, mask, res);
+  return res;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "bitset.h"
+
+// Packs the bits of `source` selected by `mask` into a dense bitset of `mask.count()` bits
+bitset extract(const bitset::const_view& source, const bitset::const_view& mask);
+
+// Inverse of `extract`: spreads the leading bits of `dense` over the positions set in `mask`
+bitset deposit(const bitset::const_view& dense, const bitset::const_view& mask);
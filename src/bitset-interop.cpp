@@ -0,0 +1,203 @@
+#include "bitset.h"
+
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define BITSET_AVX2_DISPATCH
+#endif
+
+// `bitset::from_words`, `from_bytes`, `to_words` and `to_bytes` live here with their SIMD kernels.
+//
+// Every conversion is a per-word combination of two involutions that commute: reversing the
+// bytes of a word and reversing the bits of every byte (both together reverse the whole word).
+// A `msb_first` word is the big-endian reading of `msb_first` bytes, and the bit reversal of
+// the little-endian reading of `lsb_first` bytes.
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr std::size_t WORD_BYTES = sizeof(word_type);
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+
+struct conversion {
+  bool swap_bytes;
+  bool reverse_bits;
+};
+
+// The words of the external bitmap are in `byte_order`
+conversion word_conversion(bit_order order, std::endian byte_order) {
+  bool lsb_first = order == bit_order::lsb_first;
+  return {(byte_order != std::endian::native) != lsb_first, lsb_first};
+}
+
+conversion byte_conversion(bit_order order) {
+  return {std::endian::native == std::endian::little, order == bit_order::lsb_first};
+}
+
+word_type swap_bytes(word_type word) {
+  word = ((word >> 8) & 0x00ff00ff00ff00ff) | ((word & 0x00ff00ff00ff00ff) << 8);
+  word = ((word >> 16) & 0x0000ffff0000ffff) | ((word & 0x0000ffff0000ffff) << 16);
+  return (word >> 32) | (word << 32);
+}
+
+word_type reverse_byte_bits(word_type word) {
+  word = ((word >> 1) & 0x5555555555555555) | ((word & 0x5555555555555555) << 1);
+  word = ((word >> 2) & 0x3333333333333333) | ((word & 0x3333333333333333) << 2);
+  return ((word >> 4) & 0x0f0f0f0f0f0f0f0f) | ((word & 0x0f0f0f0f0f0f0f0f) << 4);
+}
+
+word_type convert_word(word_type word, conversion conv) {
+  if (conv.swap_bytes) {
+    word = swap_bytes(word);
+  }
+  if (conv.reverse_bits) {
+    word = reverse_byte_bits(word);
+  }
+  return word;
+}
+
+// `count` words from `src` to `dst` (possibly the same), neither needs to be aligned
+void convert_words_portable(const std::byte* src, std::byte* dst, std::size_t count, conversion conv) {
+  for (std::size_t i = 0; i < count; ++i) {
+    word_type word;
+    std::memcpy(&word, src + i * WORD_BYTES, WORD_BYTES);
+    word = convert_word(word, conv);
+    std::memcpy(dst + i * WORD_BYTES, &word, WORD_BYTES);
+  }
+}
+
+#ifdef BITSET_AVX2_DISPATCH
+bool has_avx2() {
+  static const bool res = __builtin_cpu_supports("avx2");
+  return res;
+}
+
+// Bytes are reversed with one shuffle, bits of a byte by looking up both nibbles
+__attribute__((target("avx2"))) void convert_words_avx2(
+    const std::byte* src,
+    std::byte* dst,
+    std::size_t count,
+    conversion conv
+) {
+  // Shuffle tables of both 128-bit lanes, as little-endian 64-bit halves
+  const __m256i byte_reversal = _mm256_setr_epi64x(
+      0x0001020304050607,
+      0x08090a0b0c0d0e0f,
+      0x0001020304050607,
+      0x08090a0b0c0d0e0f
+  );
+  // Bit reversal of the low nibble, moved to the high one
+  const __m256i reversed_low = _mm256_setr_epi64x(
+      static_cast<long long>(0xe060a020c0408000),
+      static_cast<long long>(0xf070b030d0509010),
+      static_cast<long long>(0xe060a020c0408000),
+      static_cast<long long>(0xf070b030d0509010)
+  );
+  const __m256i reversed_high = _mm256_srli_epi16(reversed_low, 4);
+  const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+
+  constexpr std::size_t STEP = sizeof(__m256i) / WORD_BYTES;
+  std::size_t i = 0;
+  for (; i + STEP <= count; i += STEP) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * WORD_BYTES));
+    if (conv.swap_bytes) {
+      block = _mm256_shuffle_epi8(block, byte_reversal);
+    }
+    if (conv.reverse_bits) {
+      __m256i low = _mm256_and_si256(block, low_nibble);
+      __m256i high = _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibble);
+      block = _mm256_or_si256(_mm256_shuffle_epi8(reversed_low, low), _mm256_shuffle_epi8(reversed_high, high));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * WORD_BYTES), block);
+  }
+  convert_words_portable(src + i * WORD_BYTES, dst + i * WORD_BYTES, count - i, conv);
+}
+#endif
+
+void convert_words(const std::byte* src, std::byte* dst, std::size_t count, conversion conv) {
+  if (count == 0) {
+    return;
+  }
+  if (!conv.swap_bytes && !conv.reverse_bits) {
+    if (src != dst) {
+      std::memmove(dst, src, count * WORD_BYTES);
+    }
+    return;
+  }
+#ifdef BITSET_AVX2_DISPATCH
+  if (has_avx2()) {
+    convert_words_avx2(src, dst, count, conv);
+    return;
+  }
+#endif
+  convert_words_portable(src, dst, count, conv);
+}
+
+// Converts the storage of `bs` into `out_bytes` bytes of `out`, clearing the bits after the end
+void export_words(const bitset& bs, std::byte* out, std::size_t out_bytes, conversion conv) {
+  std::size_t full_words = bs.size() / INT_SIZE;
+  convert_words(reinterpret_cast<const std::byte*>(bs.data()), out, full_words, conv);
+  std::size_t tail = bs.size() % INT_SIZE;
+  if (tail == 0) {
+    return;
+  }
+  word_type last = convert_word(bs.data()[full_words] & (ALL_ONE << (INT_SIZE - tail)), conv);
+  std::memcpy(out + full_words * WORD_BYTES, &last, out_bytes - full_words * WORD_BYTES);
+}
+
+} // namespace
+
+bitset bitset::from_words(std::span<const word_type> words, std::size_t size, bit_order order, std::endian byte_order) {
+  assert(words.size() >= get_capacity(size));
+  bitset res = uninitialized(size);
+  convert_words(
+      reinterpret_cast<const std::byte*>(words.data()),
+      reinterpret_cast<std::byte*>(res._data),
+      res._capacity,
+      word_conversion(order, byte_order)
+  );
+  return res;
+}
+
+bitset bitset::from_bytes(std::span<const std::byte> bytes, std::size_t size, bit_order order) {
+  std::size_t used = (size + CHAR_BIT - 1) / CHAR_BIT;
+  assert(bytes.size() >= used);
+  bitset res = uninitialized(size);
+  if (used == 0) {
+    return res;
+  }
+  // Whole words of bytes, zero-padded, converted in place
+  res._data[res._capacity - 1] = 0;
+  std::memcpy(res._data, bytes.data(), used);
+  auto* data = reinterpret_cast<std::byte*>(res._data);
+  convert_words(data, data, res._capacity, byte_conversion(order));
+  return res;
+}
+
+void bitset::to_words(std::span<word_type> out, bit_order order, std::endian byte_order) const {
+  assert(out.size() >= _capacity);
+  export_words(
+      *this,
+      reinterpret_cast<std::byte*>(out.data()),
+      _capacity * WORD_BYTES,
+      word_conversion(order, byte_order)
+  );
+}
+
+void bitset::to_bytes(std::span<std::byte> out, bit_order order) const {
+  std::size_t used = (size() + CHAR_BIT - 1) / CHAR_BIT;
+  assert(out.size() >= used);
+  export_words(*this, out.data(), used, byte_conversion(order));
+}
+
+std::vector<std::byte> bitset::to_bytes(bit_order order) const {
+  std::vector<std::byte> res((size() + CHAR_BIT - 1) / CHAR_BIT);
+  to_bytes(res, order);
+  return res;
+}
@@ -5,9 +5,9 @@
 #include <cstddef>
 #include <iterator>
 
-template <typename T>
+template <typename T, bit_order Order = bit_order::msb_first>
 class bitset_iterator {
-  template <typename S>
+  template <typename S, bit_order O>
   friend class bitset_view;
 
   friend class bitset;
@@ -19,12 +19,12 @@ public:
   using difference_type = std::ptrdiff_t;
   using pointer = void;
 
-  using reference = bitset_reference<T>;
-  using const_reference = bitset_reference<const word_type>;
+  using reference = bitset_reference<T, Order>;
+  using const_reference = bitset_reference<const word_type, Order>;
 
   using iterator_category = std::random_access_iterator_tag;
 
-  friend class bitset_iterator<word_type>;
+  friend class bitset_iterator<word_type, Order>;
 
 public:
   bitset_iterator() = default;
@@ -35,18 +35,18 @@ public:
 
   ~bitset_iterator() = default;
 
-  operator bitset_iterator<const word_type>() const {
+  operator bitset_iterator<const word_type, Order>() const {
     return {_cur, _index};
   }
 
   // Element access
 
   reference operator*() const {
-    return bitset_reference(_cur + _index / INT_SIZE, _index % INT_SIZE);
+    return reference(_cur + _index / INT_SIZE, _index % INT_SIZE);
   }
 
   reference operator[](difference_type n) const {
-    return bitset_reference(_cur + (_index + n) / INT_SIZE, (_index + n) % INT_SIZE);
+    return reference(_cur + (_index + n) / INT_SIZE, (_index + n) % INT_SIZE);
   }
 
   // Comparison
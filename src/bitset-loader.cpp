@@ -0,0 +1,730 @@
+#include "bitset-loader.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BITSET_HAS_IO_URING
+#endif
+#endif
+#endif
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr std::size_t WORD_BYTES = sizeof(word_type);
+// Largest single read or write request
+constexpr std::size_t CHUNK_BYTES = std::size_t(8) << 20;
+
+[[noreturn]] void throw_io_error(int error, const char* what) {
+  throw std::system_error(error, std::generic_category(), what);
+}
+
+// Snapshot words are little-endian on disk
+void swap_to_little_endian(word_type* words, std::size_t count) {
+  if constexpr (std::endian::native == std::endian::big) {
+    for (std::size_t i = 0; i < count; ++i) {
+      word_type res = 0;
+      for (std::size_t byte = 0; byte < WORD_BYTES; ++byte) {
+        res = (res << 8) | ((words[i] >> (8 * byte)) & 0xff);
+      }
+      words[i] = res;
+    }
+  } else {
+    static_cast<void>(words);
+    static_cast<void>(count);
+  }
+}
+
+std::array<std::byte, WORD_BYTES> encode_size(uint64_t size) {
+  std::array<std::byte, WORD_BYTES> res;
+  for (std::size_t i = 0; i < WORD_BYTES; ++i) {
+    res[i] = static_cast<std::byte>(size >> (8 * i));
+  }
+  return res;
+}
+
+uint64_t decode_size(const std::array<std::byte, WORD_BYTES>& bytes) {
+  uint64_t res = 0;
+  for (std::size_t i = 0; i < WORD_BYTES; ++i) {
+    res |= std::to_integer<uint64_t>(bytes[i]) << (8 * i);
+  }
+  return res;
+}
+
+// Number of payload words of a snapshot file of `file_size` bytes
+std::size_t payload_words(uint64_t file_size) {
+  if (file_size < WORD_BYTES || file_size % WORD_BYTES != 0) {
+    throw std::invalid_argument("bitset_loader: malformed snapshot");
+  }
+  return file_size / WORD_BYTES - 1;
+}
+
+// The last, partial word of `bs` as it goes to disk: bits after the end are zeroed, as the format
+// requires, whatever the storage holds there
+word_type padded_last_word(const bitset& bs) {
+  word_type res = bs.data()[bs.size() / INT_SIZE] & ~(std::numeric_limits<word_type>::max() >> (bs.size() % INT_SIZE));
+  swap_to_little_endian(&res, 1);
+  return res;
+}
+
+void check_size(uint64_t size, std::size_t words) {
+  if ((size + INT_SIZE - 1) / INT_SIZE != words) {
+    throw std::invalid_argument("bitset_loader: size does not match the data");
+  }
+}
+
+} // namespace
+
+// io_uring
+
+#ifdef BITSET_HAS_IO_URING
+
+// Minimal io_uring driver on raw system calls: one submission ring shared under a mutex and
+// a completion thread that reaps completions and passes them to a handler. Requests beyond
+// the ring size wait in a backlog, so submitting never blocks. Requests the kernel refuses to
+// take are completed with the error right away, on the thread that tried to submit them.
+class bitset_loader::uring {
+public:
+  using handler = std::function<void(uint64_t user_data, int result)>;
+
+  static std::unique_ptr<uring> create(unsigned entries, handler on_complete) {
+    io_uring_params params{};
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      return nullptr;
+    }
+    std::unique_ptr<uring> res(new uring(fd, std::move(on_complete)));
+    // `IORING_OP_READ`/`IORING_OP_WRITE` came with the same kernel as this feature
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0 || !res->map(params)) {
+      return nullptr;
+    }
+    res->_completion = std::thread(&uring::completion_loop, res.get());
+    return res;
+  }
+
+  ~uring() {
+    if (_completion.joinable()) {
+      stop();
+      _completion.join();
+    }
+    if (_sqes != nullptr) {
+      munmap(_sqes, _sqes_size);
+    }
+    if (_cq_ring != nullptr && _cq_ring != _sq_ring) {
+      munmap(_cq_ring, _cq_ring_size);
+    }
+    if (_sq_ring != nullptr) {
+      munmap(_sq_ring, _sq_ring_size);
+    }
+    ::close(_fd);
+  }
+
+  void submit(bool write, int fd, void* data, std::size_t length, uint64_t offset, uint64_t user_data) {
+    assert(user_data != STOP);
+    submit({write ? IORING_OP_WRITE : IORING_OP_READ, fd, data, static_cast<unsigned>(length), offset, user_data});
+  }
+
+private:
+  struct operation {
+    uint8_t opcode;
+    int fd;
+    void* data;
+    unsigned length;
+    uint64_t offset;
+    uint64_t user_data;
+  };
+
+  static constexpr uint64_t STOP = 0;
+  // Bounds of the pause before retrying a failed system call
+  static constexpr std::chrono::milliseconds MIN_BACKOFF{1};
+  static constexpr std::chrono::milliseconds MAX_BACKOFF{100};
+
+  // `user_data` of a request that was not submitted and the error
+  using failure = std::pair<uint64_t, int>;
+
+  int _fd;
+  handler _on_complete;
+
+  void* _sq_ring = nullptr;
+  std::size_t _sq_ring_size = 0;
+  void* _cq_ring = nullptr;
+  std::size_t _cq_ring_size = 0;
+  io_uring_sqe* _sqes = nullptr;
+  std::size_t _sqes_size = 0;
+
+  unsigned* _sq_tail;
+  unsigned* _sq_mask;
+  unsigned* _sq_array;
+  unsigned* _cq_head;
+  unsigned* _cq_tail;
+  unsigned* _cq_mask;
+  io_uring_cqe* _cqes;
+  unsigned _entries;
+
+  std::mutex _mutex;
+  unsigned _in_flight = 0;
+  unsigned _unsubmitted = 0;
+  std::deque<operation> _backlog;
+
+  std::thread _completion;
+
+  uring(int fd, handler on_complete)
+      : _fd(fd)
+      , _on_complete(std::move(on_complete)) {}
+
+  template <class U>
+  static U* at(void* base, std::size_t offset) {
+    return reinterpret_cast<U*>(static_cast<char*>(base) + offset);
+  }
+
+  static void* map_region(int fd, std::size_t size, off_t offset) {
+    void* res = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return res == MAP_FAILED ? nullptr : res;
+  }
+
+  bool map(const io_uring_params& params) {
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+    }
+    _sq_ring = map_region(_fd, _sq_ring_size, IORING_OFF_SQ_RING);
+    if (_sq_ring == nullptr) {
+      return false;
+    }
+    _cq_ring = single_mmap ? _sq_ring : map_region(_fd, _cq_ring_size, IORING_OFF_CQ_RING);
+    _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = static_cast<io_uring_sqe*>(map_region(_fd, _sqes_size, IORING_OFF_SQES));
+    if (_cq_ring == nullptr || _sqes == nullptr) {
+      return false;
+    }
+
+    _sq_tail = at<unsigned>(_sq_ring, params.sq_off.tail);
+    _sq_mask = at<unsigned>(_sq_ring, params.sq_off.ring_mask);
+    _sq_array = at<unsigned>(_sq_ring, params.sq_off.array);
+    _cq_head = at<unsigned>(_cq_ring, params.cq_off.head);
+    _cq_tail = at<unsigned>(_cq_ring, params.cq_off.tail);
+    _cq_mask = at<unsigned>(_cq_ring, params.cq_off.ring_mask);
+    _cqes = at<io_uring_cqe>(_cq_ring, params.cq_off.cqes);
+    _entries = params.sq_entries;
+    return true;
+  }
+
+  int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, _fd, to_submit, min_complete, flags, nullptr, 0));
+  }
+
+  void submit(const operation& op) {
+    std::vector<failure> failed;
+    {
+      std::lock_guard lock(_mutex);
+      if (_in_flight < _entries) {
+        push(op, failed);
+      } else {
+        _backlog.push_back(op);
+      }
+    }
+    for (auto [user_data, error] : failed) {
+      _on_complete(user_data, -error);
+    }
+  }
+
+  // The completion thread only returns on the `STOP` entry, so keep offering it. The ring is
+  // idle by now, so a refusal can only be transient.
+  void stop() {
+    for (auto backoff = MIN_BACKOFF;; backoff = std::min(2 * backoff, MAX_BACKOFF)) {
+      std::vector<failure> failed;
+      {
+        std::lock_guard lock(_mutex);
+        if (_in_flight < _entries) {
+          push({IORING_OP_NOP, -1, nullptr, 0, 0, STOP}, failed);
+        } else {
+          _backlog.push_back({IORING_OP_NOP, -1, nullptr, 0, 0, STOP});
+        }
+      }
+      if (failed.empty()) {
+        return;
+      }
+      std::this_thread::sleep_for(backoff);
+    }
+  }
+
+  // Requires `_mutex`. Entries the kernel refuses are added to `failed`.
+  void push(const operation& op, std::vector<failure>& failed) {
+    // Nothing is left unsubmitted between calls; reserve now so that reporting cannot throw
+    failed.reserve(failed.size() + 1);
+    unsigned tail = std::atomic_ref(*_sq_tail).load(std::memory_order_relaxed);
+    unsigned index = tail & *_sq_mask;
+    io_uring_sqe& sqe = _sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = op.opcode;
+    sqe.fd = op.fd;
+    sqe.addr = reinterpret_cast<uint64_t>(op.data);
+    sqe.len = op.length;
+    sqe.off = op.offset;
+    sqe.user_data = op.user_data;
+    _sq_array[index] = index;
+    std::atomic_ref(*_sq_tail).store(tail + 1, std::memory_order_release);
+    ++_in_flight;
+    ++_unsubmitted;
+    flush(failed);
+  }
+
+  // Requires `_mutex`. Nothing consumes the ring between calls, so entries the kernel did not
+  // take are the last `_unsubmitted` ones: on failure they are taken back out and reported.
+  void flush(std::vector<failure>& failed) {
+    while (_unsubmitted > 0) {
+      int res = enter(_unsubmitted, 0, 0);
+      if (res >= 0) {
+        _unsubmitted -= res;
+        continue;
+      }
+      int error = errno;
+      if (error == EINTR) {
+        continue;
+      }
+      unsigned tail = std::atomic_ref(*_sq_tail).load(std::memory_order_relaxed);
+      for (unsigned i = tail - _unsubmitted; i != tail; ++i) {
+        failed.emplace_back(_sqes[i & *_sq_mask].user_data, error);
+      }
+      std::atomic_ref(*_sq_tail).store(tail - _unsubmitted, std::memory_order_release);
+      _in_flight -= _unsubmitted;
+      _unsubmitted = 0;
+    }
+  }
+
+  void completion_loop() {
+    auto backoff = MIN_BACKOFF;
+    while (true) {
+      unsigned head = std::atomic_ref(*_cq_head).load(std::memory_order_relaxed);
+      unsigned tail = std::atomic_ref(*_cq_tail).load(std::memory_order_acquire);
+      if (head == tail) {
+        // Errors other than an interruption are transient (`EBUSY`, `EAGAIN`): pause instead of
+        // spinning until they pass
+        if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+          std::this_thread::sleep_for(backoff);
+          backoff = std::min(2 * backoff, MAX_BACKOFF);
+        } else {
+          backoff = MIN_BACKOFF;
+        }
+        continue;
+      }
+      const io_uring_cqe& cqe = _cqes[head & *_cq_mask];
+      uint64_t user_data = cqe.user_data;
+      int result = cqe.res;
+      std::atomic_ref(*_cq_head).store(head + 1, std::memory_order_release);
+
+      std::vector<failure> failed;
+      {
+        std::lock_guard lock(_mutex);
+        --_in_flight;
+        while (!_backlog.empty() && _in_flight < _entries) {
+          push(_backlog.front(), failed);
+          _backlog.pop_front();
+        }
+      }
+      bool stopping = user_data == STOP;
+      if (!stopping) {
+        _on_complete(user_data, result);
+      }
+      for (auto [failed_data, error] : failed) {
+        if (failed_data == STOP) {
+          stopping = true;
+        } else {
+          _on_complete(failed_data, -error);
+        }
+      }
+      if (stopping) {
+        return;
+      }
+    }
+  }
+};
+
+#else
+
+class bitset_loader::uring {
+public:
+  using handler = std::function<void(uint64_t user_data, int result)>;
+
+  static std::unique_ptr<uring> create(unsigned, handler) {
+    return nullptr;
+  }
+
+  void submit(bool, int, void*, std::size_t, uint64_t, uint64_t) {}
+};
+
+#endif
+
+// An io_uring load or store: the payload is split into chunks, each a separate request
+struct bitset_loader::request {
+  struct chunk {
+    request* owner;
+    void* data;
+    std::size_t length;
+    uint64_t offset;
+  };
+
+  bool write = false;
+  int fd = -1;
+  // Destination of a load, a little-endian copy of the source of a store on big-endian hosts
+  bitset bits;
+  // Padded last word of a store
+  word_type last_word = 0;
+  std::array<std::byte, WORD_BYTES> size_bytes{};
+  std::vector<chunk> chunks;
+  // Chunks not completed yet, plus one held by the submitter until the callback is in place
+  std::atomic<std::size_t> remaining = 0;
+  // Chunks fail on the completion thread or, if not submitted, on the submitting one
+  std::atomic<int> error = 0;
+  // Thrown while submitting, after some of the chunks were submitted already
+  std::exception_ptr submit_error;
+
+  load_callback on_load;
+  store_callback on_store;
+
+  void add_chunks(void* payload, std::size_t bytes, uint64_t file_offset = 0) {
+    for (std::size_t offset = 0; offset < bytes; offset += CHUNK_BYTES) {
+      std::size_t length = std::min(CHUNK_BYTES, bytes - offset);
+      chunks.push_back({this, static_cast<std::byte*>(payload) + offset, length, file_offset + offset});
+    }
+  }
+
+  // The trailer goes last, at `file_offset`
+  void finish_chunks(uint64_t file_offset) {
+    chunks.push_back({this, size_bytes.data(), WORD_BYTES, file_offset});
+    remaining = chunks.size() + 1;
+  }
+
+  ~request() {
+#ifdef BITSET_HAS_IO_URING
+    if (fd >= 0) {
+      ::close(fd);
+    }
+#endif
+  }
+};
+
+// bitset_loader
+
+bitset_loader::bitset_loader(backend kind, std::size_t queue_depth, std::size_t threads) {
+  if (kind == backend::automatic) {
+    _uring = uring::create(static_cast<unsigned>(queue_depth), [this](uint64_t user_data, int result) {
+      auto* c = reinterpret_cast<request::chunk*>(user_data);
+      request* req = c->owner;
+      if (result < 0) {
+        req->error = -result;
+      } else if (static_cast<std::size_t>(result) != c->length && req->error == 0) {
+        req->error = EIO;
+      }
+      release(req, 1);
+    });
+  }
+  if (_uring == nullptr) {
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+      _workers.emplace_back(&bitset_loader::worker_loop, this);
+    }
+  }
+}
+
+bitset_loader::~bitset_loader() {
+  wait();
+  {
+    std::lock_guard lock(_tasks_mutex);
+    _stop = true;
+  }
+  _tasks_cv.notify_all();
+  for (std::thread& worker : _workers) {
+    worker.join();
+  }
+  _uring.reset();
+}
+
+bool bitset_loader::uses_io_uring() const {
+  return _uring != nullptr;
+}
+
+void bitset_loader::load(std::string path, load_callback done) {
+  begin_operation();
+  if (_uring == nullptr) {
+    std::lock_guard lock(_tasks_mutex);
+    _tasks.push_back([this, path = std::move(path), done = std::move(done)] {
+      std::exception_ptr error;
+      bitset res;
+      try {
+        res = load_blocking(path);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      done(error, std::move(res));
+      end_operation();
+    });
+    _tasks_cv.notify_one();
+    return;
+  }
+  try {
+    start_load(std::move(path), done);
+  } catch (...) {
+    done(std::current_exception(), bitset());
+    end_operation();
+  }
+}
+
+void bitset_loader::store(std::string path, const bitset& bs, store_callback done) {
+  begin_operation();
+  if (_uring == nullptr) {
+    std::lock_guard lock(_tasks_mutex);
+    _tasks.push_back([this, path = std::move(path), &bs, done = std::move(done)] {
+      std::exception_ptr error;
+      try {
+        store_blocking(path, bs);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      done(error);
+      end_operation();
+    });
+    _tasks_cv.notify_one();
+    return;
+  }
+  try {
+    start_store(std::move(path), bs, done);
+  } catch (...) {
+    done(std::current_exception());
+    end_operation();
+  }
+}
+
+bitset_loader::load_awaitable bitset_loader::load_async(std::string path) {
+  return load_awaitable(this, std::move(path));
+}
+
+bitset_loader::store_awaitable bitset_loader::store_async(std::string path, const bitset& bs) {
+  return store_awaitable(this, std::move(path), bs);
+}
+
+void bitset_loader::wait() {
+  std::unique_lock lock(_pending_mutex);
+  _pending_cv.wait(lock, [this] { return _pending == 0; });
+}
+
+void bitset_loader::begin_operation() {
+  std::lock_guard lock(_pending_mutex);
+  ++_pending;
+}
+
+void bitset_loader::end_operation() {
+  std::lock_guard lock(_pending_mutex);
+  if (--_pending == 0) {
+    _pending_cv.notify_all();
+  }
+}
+
+// `done` is only taken once some I/O is issued: until then failures are thrown to the caller
+void bitset_loader::start_load(std::string path, load_callback& done) {
+#ifdef BITSET_HAS_IO_URING
+  auto req = std::make_unique<request>();
+  req->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (req->fd < 0) {
+    throw_io_error(errno, "bitset_loader: open");
+  }
+  struct stat info;
+  if (::fstat(req->fd, &info) != 0) {
+    throw_io_error(errno, "bitset_loader: stat");
+  }
+  std::size_t words = payload_words(info.st_size);
+  // Uninitialized: every word is overwritten by the read
+  req->bits = bitset(words * INT_SIZE);
+  req->add_chunks(req->bits._data, words * WORD_BYTES);
+  req->finish_chunks(words * WORD_BYTES);
+
+  std::size_t unsubmitted = submit_chunks(req.get());
+  if (unsubmitted == req->chunks.size()) {
+    std::rethrow_exception(req->submit_error);
+  }
+  req->on_load = std::move(done);
+  release(req.release(), unsubmitted + 1);
+#else
+  static_cast<void>(path);
+  static_cast<void>(done);
+#endif
+}
+
+void bitset_loader::start_store(std::string path, const bitset& bs, store_callback& done) {
+#ifdef BITSET_HAS_IO_URING
+  auto req = std::make_unique<request>();
+  req->write = true;
+  req->fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (req->fd < 0) {
+    throw_io_error(errno, "bitset_loader: open");
+  }
+  // Full words go straight from the storage, the partial last one from a padded copy
+  std::size_t full_words = bs.size() / INT_SIZE;
+  const word_type* payload = bs._data;
+  if constexpr (std::endian::native == std::endian::big) {
+    req->bits = bs;
+    swap_to_little_endian(req->bits._data, full_words);
+    payload = req->bits._data;
+  }
+  req->size_bytes = encode_size(bs.size());
+  req->add_chunks(const_cast<word_type*>(payload), full_words * WORD_BYTES);
+  if (bs.size() % INT_SIZE != 0) {
+    req->last_word = padded_last_word(bs);
+    req->add_chunks(&req->last_word, WORD_BYTES, full_words * WORD_BYTES);
+  }
+  req->finish_chunks(bitset::get_capacity(bs.size()) * WORD_BYTES);
+
+  std::size_t unsubmitted = submit_chunks(req.get());
+  if (unsubmitted == req->chunks.size()) {
+    std::rethrow_exception(req->submit_error);
+  }
+  req->on_store = std::move(done);
+  release(req.release(), unsubmitted + 1);
+#else
+  static_cast<void>(path);
+  static_cast<void>(bs);
+  static_cast<void>(done);
+#endif
+}
+
+// Returns the number of chunks left unsubmitted because submitting threw, see `submit_error`
+std::size_t bitset_loader::submit_chunks(request* req) {
+  std::size_t submitted = 0;
+  try {
+    for (request::chunk& c : req->chunks) {
+      _uring->submit(req->write, req->fd, c.data, c.length, c.offset, reinterpret_cast<uint64_t>(&c));
+      ++submitted;
+    }
+  } catch (...) {
+    req->submit_error = std::current_exception();
+  }
+  return req->chunks.size() - submitted;
+}
+
+void bitset_loader::release(request* req, std::size_t count) {
+  if (req->remaining.fetch_sub(count) == count) {
+    complete(req);
+  }
+}
+
+void bitset_loader::complete(request* owner) {
+  std::unique_ptr<request> req(owner);
+  std::exception_ptr error;
+#ifdef BITSET_HAS_IO_URING
+  if (::close(req->fd) != 0 && req->error == 0) {
+    req->error = errno;
+  }
+  req->fd = -1;
+#endif
+  try {
+    if (req->submit_error) {
+      std::rethrow_exception(req->submit_error);
+    }
+    if (req->error != 0) {
+      throw_io_error(req->error, req->write ? "bitset_loader: write" : "bitset_loader: read");
+    }
+    if (!req->write) {
+      std::size_t words = req->bits.size() / INT_SIZE;
+      uint64_t size = decode_size(req->size_bytes);
+      check_size(size, words);
+      swap_to_little_endian(req->bits._data, words);
+      req->bits._size = size;
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  if (req->write) {
+    req->on_store(error);
+  } else {
+    req->on_load(error, error ? bitset() : std::move(req->bits));
+  }
+  end_operation();
+}
+
+bitset bitset_loader::load_blocking(const std::string& path) {
+  std::size_t words = payload_words(std::filesystem::file_size(path));
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+  if (file == nullptr) {
+    throw_io_error(errno, "bitset_loader: open");
+  }
+  bitset res(words * INT_SIZE);
+  std::array<std::byte, WORD_BYTES> size_bytes;
+  if ((words > 0 && std::fread(res._data, WORD_BYTES, words, file.get()) != words) ||
+      std::fread(size_bytes.data(), 1, WORD_BYTES, file.get()) != WORD_BYTES) {
+    throw_io_error(std::ferror(file.get()) ? errno : EIO, "bitset_loader: read");
+  }
+  uint64_t size = decode_size(size_bytes);
+  check_size(size, words);
+  swap_to_little_endian(res._data, words);
+  res._size = size;
+  return res;
+}
+
+void bitset_loader::store_blocking(const std::string& path, const bitset& bs) {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+  if (file == nullptr) {
+    throw_io_error(errno, "bitset_loader: open");
+  }
+  std::size_t full_words = bs.size() / INT_SIZE;
+  const word_type* payload = bs._data;
+  bitset copy;
+  if constexpr (std::endian::native == std::endian::big) {
+    copy = bs;
+    swap_to_little_endian(copy._data, full_words);
+    payload = copy._data;
+  }
+  bool partial = bs.size() % INT_SIZE != 0;
+  word_type last_word = partial ? padded_last_word(bs) : 0;
+  std::array<std::byte, WORD_BYTES> size_bytes = encode_size(bs.size());
+  if ((full_words > 0 && std::fwrite(payload, WORD_BYTES, full_words, file.get()) != full_words) ||
+      (partial && std::fwrite(&last_word, WORD_BYTES, 1, file.get()) != 1) ||
+      std::fwrite(size_bytes.data(), 1, WORD_BYTES, file.get()) != WORD_BYTES) {
+    throw_io_error(errno, "bitset_loader: write");
+  }
+  if (std::fclose(file.release()) != 0) {
+    throw_io_error(errno, "bitset_loader: close");
+  }
+}
+
+void bitset_loader::worker_loop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(_tasks_mutex);
+      _tasks_cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+      if (_tasks.empty()) {
+        return;
+      }
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous loading and storing of bitset snapshots in the `bitset-stream.h` format.
+// On Linux with io_uring the word payload is read (written) straight into (from) the bitset
+// storage by the kernel and completions are delivered on a single completion thread; elsewhere,
+// or if io_uring is unavailable, every operation runs on a thread pool with blocking I/O.
+//
+// Callbacks run on the completion thread or a pool thread, or on the calling thread if the
+// operation fails before any I/O is issued (e.g. the file does not exist). Errors are passed
+// as `std::system_error` (I/O) or `std::invalid_argument` (malformed snapshot).
+class bitset_loader {
+public:
+  using load_callback = std::function<void(std::exception_ptr error, bitset result)>;
+  using store_callback = std::function<void(std::exception_ptr error)>;
+
+  enum class backend : uint8_t {
+    automatic,
+    thread_pool,
+  };
+
+  class load_awaitable;
+  class store_awaitable;
+
+  // `queue_depth` bounds the I/O requests in flight in io_uring, `threads` sizes the pool
+  // (0 means `std::thread::hardware_concurrency()`)
+  explicit bitset_loader(backend kind = backend::automatic, std::size_t queue_depth = 256, std::size_t threads = 0);
+
+  bitset_loader(const bitset_loader&) = delete;
+  bitset_loader& operator=(const bitset_loader&) = delete;
+
+  // Waits for all pending operations
+  ~bitset_loader();
+
+  bool uses_io_uring() const;
+
+  void load(std::string path, load_callback done);
+  // `bs` must stay alive and unchanged until `done` is called
+  void store(std::string path, const bitset& bs, store_callback done);
+
+  // `co_await loader.load_async(path)` returns the bitset or throws
+  load_awaitable load_async(std::string path);
+  store_awaitable store_async(std::string path, const bitset& bs);
+
+  // Blocks until no operation is pending
+  void wait();
+
+private:
+  class uring;
+  struct request;
+
+  std::unique_ptr<uring> _uring;
+
+  std::vector<std::thread> _workers;
+  std::deque<std::function<void()>> _tasks;
+  std::mutex _tasks_mutex;
+  std::condition_variable _tasks_cv;
+  bool _stop = false;
+
+  std::size_t _pending = 0;
+  std::mutex _pending_mutex;
+  std::condition_variable _pending_cv;
+
+  void begin_operation();
+  void end_operation();
+
+  void start_load(std::string path, load_callback& done);
+  void start_store(std::string path, const bitset& bs, store_callback& done);
+  std::size_t submit_chunks(request* req);
+  void release(request* req, std::size_t count);
+  void complete(request* req);
+
+  static bitset load_blocking(const std::string& path);
+  static void store_blocking(const std::string& path, const bitset& bs);
+
+  void worker_loop();
+};
+
+class bitset_loader::load_awaitable {
+public:
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    _handle = handle;
+    _loader->load(std::move(_path), [this](std::exception_ptr error, bitset result) {
+      _error = std::move(error);
+      _result = std::move(result);
+      // Whoever comes second resumes: the callback may run before `await_suspend` returns
+      if (_done.exchange(true)) {
+        _handle.resume();
+      }
+    });
+    return !_done.exchange(true);
+  }
+
+  bitset await_resume() {
+    if (_error) {
+      std::rethrow_exception(_error);
+    }
+    return std::move(_result);
+  }
+
+private:
+  friend class bitset_loader;
+
+  bitset_loader* _loader;
+  std::string _path;
+  std::coroutine_handle<> _handle;
+  std::exception_ptr _error;
+  bitset _result;
+  std::atomic<bool> _done = false;
+
+  load_awaitable(bitset_loader* loader, std::string path)
+      : _loader(loader)
+      , _path(std::move(path)) {}
+};
+
+class bitset_loader::store_awaitable {
+public:
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    _handle = handle;
+    _loader->store(std::move(_path), *_bits, [this](std::exception_ptr error) {
+      _error = std::move(error);
+      if (_done.exchange(true)) {
+        _handle.resume();
+      }
+    });
+    return !_done.exchange(true);
+  }
+
+  void await_resume() {
+    if (_error) {
+      std::rethrow_exception(_error);
+    }
+  }
+
+private:
+  friend class bitset_loader;
+
+  bitset_loader* _loader;
+  std::string _path;
+  const bitset* _bits;
+  std::coroutine_handle<> _handle;
+  std::exception_ptr _error;
+  std::atomic<bool> _done = false;
+
+  store_awaitable(bitset_loader* loader, std::string path, const bitset& bs)
+      : _loader(loader)
+      , _path(std::move(path))
+      , _bits(&bs) {}
+};
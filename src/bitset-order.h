@@ -0,0 +1,109 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Order of bits in a storage word (or a byte of an external bitmap): `msb_first` is how `bitset` stores its
+// words, `lsb_first` is used by Arrow, Parquet, Roaring, numpy `packbits(bitorder="little")` and
+// `boost::dynamic_bitset`
+enum class bit_order : uint8_t {
+  msb_first,
+  lsb_first,
+};
+
+// Word primitives of a bit order. Positions 0..63 of a word follow the order of the bits:
+// from the most significant bit for `msb_first`, from the least significant one for `lsb_first`.
+template <bit_order Order>
+struct bit_order_traits;
+
+template <>
+struct bit_order_traits<bit_order::msb_first> {
+  using word_type = uint64_t;
+
+  static constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+  static constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+
+  static constexpr word_type bit(std::size_t pos) {
+    return word_type(1) << (INT_SIZE - 1 - pos);
+  }
+
+  // Positions [0, count)
+  static constexpr word_type prefix(std::size_t count) {
+    return count == 0 ? 0 : ALL_ONE << (INT_SIZE - count);
+  }
+
+  // Positions [pos, 64), `pos < 64`
+  static constexpr word_type suffix(std::size_t pos) {
+    return ALL_ONE >> pos;
+  }
+
+  // Moves position `pos + shift` to `pos`, `shift < 64`
+  static constexpr word_type to_front(word_type word, std::size_t shift) {
+    return word << shift;
+  }
+
+  // Moves position `pos` to `pos + shift`, `shift < 64`
+  static constexpr word_type to_back(word_type word, std::size_t shift) {
+    return word >> shift;
+  }
+
+  // First position of a set bit, 64 if there is none
+  static constexpr std::size_t first_one(word_type word) {
+    return std::countl_zero(word);
+  }
+
+  // Positions [offset, offset + count) as the low `count` bits of the result, `count > 0`
+  static constexpr word_type extract(word_type word, std::size_t offset, std::size_t count) {
+    return (word & suffix(offset)) >> (INT_SIZE - offset - count);
+  }
+
+  // Inverse of `extract`: replaces positions [offset, offset + count) with the low bits of `value`
+  static constexpr void deposit(word_type& word, std::size_t offset, std::size_t count, word_type value) {
+    std::size_t shift = INT_SIZE - offset - count;
+    word_type mask = (ALL_ONE >> (INT_SIZE - count)) << shift;
+    word = (word & ~mask) | ((value << shift) & mask);
+  }
+};
+
+template <>
+struct bit_order_traits<bit_order::lsb_first> {
+  using word_type = uint64_t;
+
+  static constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+  static constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+
+  static constexpr word_type bit(std::size_t pos) {
+    return word_type(1) << pos;
+  }
+
+  static constexpr word_type prefix(std::size_t count) {
+    return count == 0 ? 0 : ALL_ONE >> (INT_SIZE - count);
+  }
+
+  static constexpr word_type suffix(std::size_t pos) {
+    return ALL_ONE << pos;
+  }
+
+  static constexpr word_type to_front(word_type word, std::size_t shift) {
+    return word >> shift;
+  }
+
+  static constexpr word_type to_back(word_type word, std::size_t shift) {
+    return word << shift;
+  }
+
+  static constexpr std::size_t first_one(word_type word) {
+    return std::countr_zero(word);
+  }
+
+  static constexpr word_type extract(word_type word, std::size_t offset, std::size_t count) {
+    return (word >> offset) & (ALL_ONE >> (INT_SIZE - count));
+  }
+
+  static constexpr void deposit(word_type& word, std::size_t offset, std::size_t count, word_type value) {
+    word_type mask = (ALL_ONE >> (INT_SIZE - count)) << offset;
+    word = (word & ~mask) | ((value << offset) & mask);
+  }
+};
@@ -0,0 +1,159 @@
+#include "bitset-parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<bitset::word_type>::digits;
+
+std::size_t thread_count(std::size_t size, std::size_t threads) {
+  if (size < PARALLEL_MIN_SIZE) {
+    return 1;
+  }
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return std::min(threads, (size + INT_SIZE - 1) / INT_SIZE);
+}
+
+// CPUs the calling thread may run on, in increasing order; empty if unknown
+std::vector<int> allowed_cpus() {
+  std::vector<int> res;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        res.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return res;
+}
+
+// Pins the calling thread to the `chunk`-th of `cpus` (cyclically); a failure leaves it unpinned
+void pin_chunk(const std::vector<int>& cpus, std::size_t chunk) {
+#if defined(__linux__)
+  if (cpus.empty()) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpus[chunk % cpus.size()], &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  static_cast<void>(cpus);
+  static_cast<void>(chunk);
+#endif
+}
+
+// Joins every started thread on scope exit, including unwinding
+class join_guard {
+public:
+  explicit join_guard(std::vector<std::thread>& threads)
+      : _threads(threads) {}
+
+  join_guard(const join_guard&) = delete;
+  join_guard& operator=(const join_guard&) = delete;
+
+  ~join_guard() {
+    for (std::thread& thread : _threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+private:
+  std::vector<std::thread>& _threads;
+};
+
+// Calls `f(chunk, first, count)` for every chunk of whole words
+template <class Function>
+void for_each_chunk(std::size_t size, std::size_t threads, Function f) {
+  threads = thread_count(size, threads);
+  std::size_t words = (size + INT_SIZE - 1) / INT_SIZE;
+  auto chunk_first = [&](std::size_t chunk) { return std::min(words * chunk / threads * INT_SIZE, size); };
+
+  parallel_for_chunks(threads, [&](std::size_t chunk) {
+    std::size_t first = chunk_first(chunk);
+    f(chunk, first, chunk_first(chunk + 1) - first);
+  });
+}
+
+} // namespace
+
+bitset parallel_bitset(std::size_t size, bool value, std::size_t threads) {
+  bitset res = bitset::uninitialized(size);
+  for_each_chunk(size, threads, [&res, value](std::size_t, std::size_t first, std::size_t count) {
+    if (value) {
+      res.subview(first, count).set();
+    } else {
+      res.subview(first, count).reset();
+    }
+  });
+  return res;
+}
+
+std::size_t parallel_count(const bitset::const_view& bs, std::size_t threads) {
+  std::vector<std::size_t> counts(thread_count(bs.size(), threads));
+  for_each_chunk(bs.size(), threads, [&bs, &counts](std::size_t chunk, std::size_t first, std::size_t count) {
+    counts[chunk] = bs.subview(first, count).count();
+  });
+  std::size_t res = 0;
+  for (std::size_t count : counts) {
+    res += count;
+  }
+  return res;
+}
+
+void parallel_and(bitset& lhs, const bitset::const_view& rhs, std::size_t threads) {
+  assert(lhs.size() == rhs.size());
+  for_each_chunk(lhs.size(), threads, [&lhs, &rhs](std::size_t, std::size_t first, std::size_t count) {
+    lhs.subview(first, count) &= rhs.subview(first, count);
+  });
+}
+
+void parallel_or(bitset& lhs, const bitset::const_view& rhs, std::size_t threads) {
+  assert(lhs.size() == rhs.size());
+  for_each_chunk(lhs.size(), threads, [&lhs, &rhs](std::size_t, std::size_t first, std::size_t count) {
+    lhs.subview(first, count) |= rhs.subview(first, count);
+  });
+}
+
+void parallel_xor(bitset& lhs, const bitset::const_view& rhs, std::size_t threads) {
+  assert(lhs.size() == rhs.size());
+  for_each_chunk(lhs.size(), threads, [&lhs, &rhs](std::size_t, std::size_t first, std::size_t count) {
+    lhs.subview(first, count) ^= rhs.subview(first, count);
+  });
+}
+
+void parallel_for_chunks(std::size_t chunks, const std::function<void(std::size_t)>& f) {
+  if (chunks <= 1) {
+    if (chunks == 1) {
+      f(0);
+    }
+    return;
+  }
+  std::vector<int> cpus = allowed_cpus();
+  std::vector<std::thread> workers;
+  workers.reserve(chunks);
+  join_guard guard(workers);
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    workers.emplace_back([&f, &cpus, chunk] {
+      pin_chunk(cpus, chunk);
+      f(chunk);
+    });
+  }
+}
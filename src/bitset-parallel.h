@@ -0,0 +1,31 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <functional>
+
+// Multi-threaded construction and scans of large bitsets. All of them split the words into the
+// same contiguous chunks, one per thread, and on Linux pin the thread of chunk `k` to the same CPU
+// in every call, so a scan thread runs where the matching construction thread touched the pages
+// first; with first-touch placement these pages are local to its NUMA node. `threads == 0` means
+// `std::thread::hardware_concurrency()`. Bitsets smaller than `PARALLEL_MIN_SIZE` bits are
+// processed by the calling thread.
+//
+// The destination of the binary operations is a whole `bitset`, so that chunks never share a word.
+// A `prefault` allocation policy touches every page from the allocating thread and defeats this.
+
+inline constexpr std::size_t PARALLEL_MIN_SIZE = std::size_t(1) << 21;
+
+bitset parallel_bitset(std::size_t size, bool value, std::size_t threads = 0);
+
+std::size_t parallel_count(const bitset::const_view& bs, std::size_t threads = 0);
+
+void parallel_and(bitset& lhs, const bitset::const_view& rhs, std::size_t threads = 0);
+void parallel_or(bitset& lhs, const bitset::const_view& rhs, std::size_t threads = 0);
+void parallel_xor(bitset& lhs, const bitset::const_view& rhs, std::size_t threads = 0);
+
+// Calls `f(chunk)` for every chunk in `[0, chunks)` and waits for all of them. With more than one
+// chunk every call runs on a thread of its own, pinned as described above; the threads already
+// started are joined before an exception from starting the next one propagates.
+void parallel_for_chunks(std::size_t chunks, const std::function<void(std::size_t)>& f);
@@ -0,0 +1,194 @@
+#include "bitset-random.h"
+
+#include "bitset-parallel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+constexpr std::size_t BLOCK_WORDS = RANDOM_BLOCK_SIZE / INT_SIZE;
+
+constexpr std::array<uint64_t, 4> JUMP = {
+    0x180ec6d33cfd0aba,
+    0xd5a61266f0c9392c,
+    0xa9582618e03fc9aa,
+    0x39abdc4529b1661c,
+};
+
+uint64_t splitmix64(uint64_t& state) {
+  uint64_t res = state += 0x9e3779b97f4a7c15;
+  res = (res ^ (res >> 30)) * 0xbf58476d1ce4e5b9;
+  res = (res ^ (res >> 27)) * 0x94d049bb133111eb;
+  return res ^ (res >> 31);
+}
+
+// Fills the words of one block with bits of a fixed density
+class block_filler {
+public:
+  explicit block_filler(double density) {
+    assert(0 <= density && density <= 1);
+    if (density == 0) {
+      _kind = kind::zeros;
+    } else if (density == 1) {
+      _kind = kind::ones;
+    } else if (density < RANDOM_SPARSE_DENSITY || density > 1 - RANDOM_SPARSE_DENSITY) {
+      // Sample the minority bits and flip them
+      _kind = density < 0.5 ? kind::sparse_ones : kind::sparse_zeros;
+      _log_keep = std::log1p(-std::min(density, 1 - density));
+    } else {
+      _kind = kind::dense;
+      _digits = static_cast<uint64_t>(std::llround(std::ldexp(density, RANDOM_PRECISION)));
+    }
+  }
+
+  void operator()(word_type* words, std::size_t count, xoshiro256& rng) const {
+    switch (_kind) {
+    case kind::zeros:
+      std::fill_n(words, count, 0);
+      break;
+    case kind::ones:
+      std::fill_n(words, count, ALL_ONE);
+      break;
+    case kind::dense:
+      fill_dense(words, count, rng);
+      break;
+    case kind::sparse_ones:
+      std::fill_n(words, count, 0);
+      flip_sparse(words, count, rng);
+      break;
+    case kind::sparse_zeros:
+      std::fill_n(words, count, ALL_ONE);
+      flip_sparse(words, count, rng);
+      break;
+    }
+  }
+
+private:
+  enum class kind : uint8_t {
+    zeros,
+    ones,
+    dense,
+    sparse_ones,
+    sparse_zeros,
+  };
+
+  kind _kind;
+  // `density` in fixed point with `RANDOM_PRECISION` fractional bits
+  uint64_t _digits = 0;
+  // Logarithm of the probability that a bit is not flipped
+  double _log_keep = 0;
+
+  // Starting from the lowest nonzero digit, a word of density d combined with fresh output
+  // becomes of density (1 + d) / 2 with OR and d / 2 with AND
+  void fill_dense(word_type* words, std::size_t count, xoshiro256& rng) const {
+    std::size_t lowest = std::countr_zero(_digits);
+    for (std::size_t i = 0; i < count; ++i) {
+      word_type word = rng();
+      for (std::size_t digit = lowest + 1; digit < RANDOM_PRECISION; ++digit) {
+        word = ((_digits >> digit) & 1) != 0 ? word | rng() : word & rng();
+      }
+      words[i] = word;
+    }
+  }
+
+  // Gaps between flipped bits are geometric: floor(log(u) / log(1 - q)) for uniform u in (0, 1]
+  void flip_sparse(word_type* words, std::size_t count, xoshiro256& rng) const {
+    std::size_t bits = count * INT_SIZE;
+    std::size_t pos = 0;
+    while (true) {
+      double uniform = std::ldexp(static_cast<double>((rng() >> 11) + 1), -53);
+      double gap = std::floor(std::log(uniform) / _log_keep);
+      if (gap >= static_cast<double>(bits - pos)) {
+        return;
+      }
+      pos += static_cast<std::size_t>(gap);
+      words[pos / INT_SIZE] ^= word_type(1) << (INT_SIZE - 1 - pos % INT_SIZE);
+      if (++pos == bits) {
+        return;
+      }
+    }
+  }
+};
+
+} // namespace
+
+// xoshiro256
+
+xoshiro256::xoshiro256(uint64_t seed) {
+  for (uint64_t& word : _state) {
+    word = splitmix64(seed);
+  }
+}
+
+xoshiro256::result_type xoshiro256::operator()() {
+  uint64_t res = std::rotl(_state[1] * 5, 7) * 9;
+  uint64_t shifted = _state[1] << 17;
+  _state[2] ^= _state[0];
+  _state[3] ^= _state[1];
+  _state[1] ^= _state[2];
+  _state[0] ^= _state[3];
+  _state[2] ^= shifted;
+  _state[3] = std::rotl(_state[3], 45);
+  return res;
+}
+
+void xoshiro256::jump() {
+  std::array<uint64_t, 4> res = {};
+  for (uint64_t jump : JUMP) {
+    for (std::size_t bit = 0; bit < 64; ++bit) {
+      if ((jump >> bit) & 1) {
+        for (std::size_t i = 0; i < res.size(); ++i) {
+          res[i] ^= _state[i];
+        }
+      }
+      (*this)();
+    }
+  }
+  _state = res;
+}
+
+// bitset::random lives here to keep the generator out of `bitset.h`
+
+bitset bitset::random(std::size_t size, xoshiro256& rng, double density, std::size_t threads) {
+  bitset res = uninitialized(size);
+  block_filler filler(density);
+  std::size_t words = res._capacity;
+  std::size_t blocks = (words + BLOCK_WORDS - 1) / BLOCK_WORDS;
+
+  auto fill_blocks = [&res, &filler, words](xoshiro256 block_rng, std::size_t first, std::size_t last) {
+    for (std::size_t block = first; block < last; ++block) {
+      xoshiro256 gen = block_rng;
+      std::size_t offset = block * BLOCK_WORDS;
+      filler(res._data + offset, std::min(BLOCK_WORDS, words - offset), gen);
+      block_rng.jump();
+    }
+  };
+
+  std::size_t thread_count = 1;
+  if (size >= PARALLEL_MIN_SIZE) {
+    thread_count = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    thread_count = std::min(thread_count, blocks);
+  }
+  // Generators are jumped ahead here, so that the chunks only read them
+  std::vector<xoshiro256> starts;
+  starts.reserve(thread_count);
+  for (std::size_t chunk = 0; chunk < thread_count; ++chunk) {
+    starts.push_back(rng);
+    for (std::size_t block = blocks * chunk / thread_count; block < blocks * (chunk + 1) / thread_count; ++block) {
+      rng.jump();
+    }
+  }
+  parallel_for_chunks(thread_count, [&](std::size_t chunk) {
+    fill_blocks(starts[chunk], blocks * chunk / thread_count, blocks * (chunk + 1) / thread_count);
+  });
+  return res;
+}
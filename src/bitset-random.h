@@ -0,0 +1,52 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// xoshiro256** by Blackman and Vigna: a fast 64-bit generator with a `jump()` that splits it
+// into 2^128 non-overlapping streams. Satisfies UniformRandomBitGenerator.
+class xoshiro256 {
+public:
+  using result_type = uint64_t;
+
+  // The state is expanded from `seed` with splitmix64
+  explicit xoshiro256(uint64_t seed);
+
+  static constexpr result_type min() {
+    return 0;
+  }
+
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()();
+
+  // Advances the state by 2^128 steps
+  void jump();
+
+  friend bool operator==(const xoshiro256& lhs, const xoshiro256& rhs) = default;
+
+private:
+  std::array<uint64_t, 4> _state;
+};
+
+// `bitset::random(size, rng, density, threads)` sets every bit independently with probability
+// `density`:
+// - 1/2: the words are the generator output;
+// - other densities: every word combines words of output with AND/OR following the binary
+//   expansion of `density` (rounded to `RANDOM_PRECISION` bits), one output word per digit;
+// - below `RANDOM_SPARSE_DENSITY` (or above 1 minus it): positions of ones (zeros) are sampled
+//   with geometric skips, so the cost is proportional to their number.
+//
+// The bitset is generated in blocks of `RANDOM_BLOCK_SIZE` bits, the k-th of them from `rng`
+// jumped k times, and `rng` is left jumped once per block. Blocks are spread over `threads`
+// (see `bitset-parallel.h`), while the result depends only on the seed, not on the thread count.
+
+inline constexpr std::size_t RANDOM_PRECISION = 32;
+inline constexpr double RANDOM_SPARSE_DENSITY = 1.0 / 64;
+inline constexpr std::size_t RANDOM_BLOCK_SIZE = std::size_t(1) << 20;
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "bitset-order.h"
+
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 
-template <typename T>
+template <typename T, bit_order Order = bit_order::msb_first>
 class bitset_reference {
 public:
   using pointer = T*;
@@ -42,7 +44,7 @@ public:
     return (*_p & get_mask()) != 0;
   }
 
-  operator bitset_reference<const word_type>() const {
+  operator bitset_reference<const word_type, Order>() const {
     return {_p, _index};
   }
 
@@ -59,10 +61,7 @@ private:
   pointer _p;
   std::size_t _index;
 
-  static const std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
-
   word_type get_mask() const {
-    word_type ONE = 1;
-    return ONE << (INT_SIZE - _index - 1);
+    return bit_order_traits<Order>::bit(_index);
   }
 };
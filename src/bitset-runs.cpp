@@ -0,0 +1,105 @@
+#include "bitset-runs.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+constexpr word_type HIGH_BIT = ~(ALL_ONE >> 1);
+
+word_type mask_high(std::size_t count) {
+  return count == 0 ? 0 : ALL_ONE << (INT_SIZE - count);
+}
+
+// `count` bits at `pos`, high-aligned, complemented if runs of zeros are looked for
+word_type load_word(const bitset::const_view& bs, std::size_t pos, std::size_t count, bool value) {
+  word_type word = bs.read_word(pos, count);
+  return value ? word : ~word & mask_high(count);
+}
+
+// Prefix XOR within a word, from the most significant bit down: log-step doubling
+word_type word_prefix_xor(word_type word) {
+  for (std::size_t shift = 1; shift < INT_SIZE; shift *= 2) {
+    word ^= word >> shift;
+  }
+  return word;
+}
+
+} // namespace
+
+void prefix_or(const bitset::view& bs) {
+  std::size_t first = bs.find_first();
+  if (first != bitset::npos) {
+    bs.subview(first).set();
+  }
+}
+
+void prefix_xor(const bitset::view& bs) {
+  word_type carry = 0;
+  for (std::size_t pos = 0; pos < bs.size(); pos += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, bs.size() - pos);
+    word_type word = word_prefix_xor(bs.read_word(pos, count)) ^ carry;
+    bs.write_word(pos, count, word);
+    // Parity so far: the last bit of this word, spread over every position
+    carry = ((word >> (INT_SIZE - count)) & 1) != 0 ? ALL_ONE : 0;
+  }
+}
+
+std::size_t find_next_value(const bitset::const_view& bs, std::size_t pos, bool value) {
+  while (pos < bs.size()) {
+    std::size_t count = std::min(INT_SIZE, bs.size() - pos);
+    word_type word = load_word(bs, pos, count, value);
+    if (word != 0) {
+      return pos + std::countl_zero(word);
+    }
+    pos += count;
+  }
+  return bitset::npos;
+}
+
+std::size_t longest_run(const bitset::const_view& bs, bool value) {
+  std::size_t res = 0;
+  // Length of the run that reaches the end of the previous word
+  std::size_t current = 0;
+  for (std::size_t pos = 0; pos < bs.size(); pos += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, bs.size() - pos);
+    word_type word = load_word(bs, pos, count, value);
+    if (word == mask_high(count)) {
+      current += count;
+      continue;
+    }
+    // The run continuing from the previous word ends at the first zero
+    current += std::countl_one(word);
+    res = std::max(res, current);
+    // Runs inside the word: every AND with the word shifted by one shortens each run by a bit,
+    // so the number of steps until zero is the longest of them
+    word_type inner = word << std::countl_one(word);
+    for (std::size_t length = 1; inner != 0; ++length) {
+      res = std::max(res, length);
+      inner &= inner << 1;
+    }
+    // The run that reaches the end of this word continues into the next one
+    current = std::countr_one(word >> (INT_SIZE - count));
+  }
+  return std::max(res, current);
+}
+
+std::size_t count_runs(const bitset::const_view& bs, bool value) {
+  std::size_t res = 0;
+  // Whether the last bit of the previous word is `value`
+  word_type previous = 0;
+  for (std::size_t pos = 0; pos < bs.size(); pos += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, bs.size() - pos);
+    word_type word = load_word(bs, pos, count, value);
+    // A run starts where the bit is set and the one before it is not
+    word_type starts = word & ~((word >> 1) | previous);
+    res += std::popcount(starts);
+    previous = ((word >> (INT_SIZE - count)) & 1) != 0 ? HIGH_BIT : 0;
+  }
+  return res;
+}
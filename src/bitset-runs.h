@@ -0,0 +1,34 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+
+// Prefix scans and runs (maximal blocks of equal bits). All of them work a word at a time.
+
+// Bit `i` becomes the OR of bits [0, i]: everything from the first one onward is set
+void prefix_or(const bitset::view& bs);
+// Bit `i` becomes the XOR (parity) of bits [0, i]
+void prefix_xor(const bitset::view& bs);
+
+// Index of the first bit equal to `value` at or after `pos`, or `npos` if there is none
+std::size_t find_next_value(const bitset::const_view& bs, std::size_t pos, bool value);
+
+// Length of the longest run of `value`, 0 if there is none
+std::size_t longest_run(const bitset::const_view& bs, bool value = true);
+// Number of runs of `value`
+std::size_t count_runs(const bitset::const_view& bs, bool value = true);
+
+// Calls `f(start, length)` for every run of `value`, in order
+template <class Function>
+void for_each_run(const bitset::const_view& bs, Function f, bool value = true) {
+  std::size_t start = find_next_value(bs, 0, value);
+  while (start != bitset::npos) {
+    std::size_t end = find_next_value(bs, start, !value);
+    if (end == bitset::npos) {
+      end = bs.size();
+    }
+    f(start, end - start);
+    start = find_next_value(bs, end, value);
+  }
+}
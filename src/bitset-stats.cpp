@@ -0,0 +1,33 @@
+#include "bitset-stats.h"
+
+bitset_stats get_bitset_stats() {
+  bitset_stats res;
+#ifdef BITSET_ENABLE_STATS
+  res.binary_ops = bitset_counters.binary_ops.load(std::memory_order_relaxed);
+  res.aligned_binary_ops = bitset_counters.aligned_binary_ops.load(std::memory_order_relaxed);
+  res.misaligned_binary_ops = bitset_counters.misaligned_binary_ops.load(std::memory_order_relaxed);
+  res.binary_bits = bitset_counters.binary_bits.load(std::memory_order_relaxed);
+  res.unary_ops = bitset_counters.unary_ops.load(std::memory_order_relaxed);
+  res.unary_bits = bitset_counters.unary_bits.load(std::memory_order_relaxed);
+  res.allocations = bitset_counters.allocations.load(std::memory_order_relaxed);
+  res.allocated_bytes = bitset_counters.allocated_bytes.load(std::memory_order_relaxed);
+  res.range_copies = bitset_counters.range_copies.load(std::memory_order_relaxed);
+  res.copied_bits = bitset_counters.copied_bits.load(std::memory_order_relaxed);
+#endif
+  return res;
+}
+
+void reset_bitset_stats() {
+#ifdef BITSET_ENABLE_STATS
+  bitset_counters.binary_ops.store(0, std::memory_order_relaxed);
+  bitset_counters.aligned_binary_ops.store(0, std::memory_order_relaxed);
+  bitset_counters.misaligned_binary_ops.store(0, std::memory_order_relaxed);
+  bitset_counters.binary_bits.store(0, std::memory_order_relaxed);
+  bitset_counters.unary_ops.store(0, std::memory_order_relaxed);
+  bitset_counters.unary_bits.store(0, std::memory_order_relaxed);
+  bitset_counters.allocations.store(0, std::memory_order_relaxed);
+  bitset_counters.allocated_bytes.store(0, std::memory_order_relaxed);
+  bitset_counters.range_copies.store(0, std::memory_order_relaxed);
+  bitset_counters.copied_bits.store(0, std::memory_order_relaxed);
+#endif
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+// Process-wide counters of the hot bitset operations. They are compiled in only when
+// `BITSET_ENABLE_STATS` is defined; otherwise the hooks expand to nothing and
+// `get_bitset_stats()` returns zeroes.
+//
+// With `BITSET_ENABLE_USDT` the same hooks also fire USDT probes of the `bitset` provider
+// (where `<sys/sdt.h>` is available): `binary_op(bits, aligned)`, `unary_op(bits)`,
+// `allocation(bytes)` and `range_copy(bits)`.
+struct bitset_stats {
+  // `bitset_view::apply_binary` calls, split by whether both operands start at the same bit
+  // offset within a word
+  uint64_t binary_ops = 0;
+  uint64_t aligned_binary_ops = 0;
+  uint64_t misaligned_binary_ops = 0;
+  uint64_t binary_bits = 0;
+
+  uint64_t unary_ops = 0;
+  uint64_t unary_bits = 0;
+
+  // Storage allocated by `bitset` constructors
+  uint64_t allocations = 0;
+  uint64_t allocated_bytes = 0;
+
+  // Iterator-range construction (copies, shifts, insertions)
+  uint64_t range_copies = 0;
+  uint64_t copied_bits = 0;
+
+  friend bool operator==(const bitset_stats& lhs, const bitset_stats& rhs) = default;
+};
+
+bitset_stats get_bitset_stats();
+void reset_bitset_stats();
+
+#ifdef BITSET_ENABLE_STATS
+
+#include <atomic>
+
+struct bitset_stats_counters {
+  std::atomic<uint64_t> binary_ops;
+  std::atomic<uint64_t> aligned_binary_ops;
+  std::atomic<uint64_t> misaligned_binary_ops;
+  std::atomic<uint64_t> binary_bits;
+  std::atomic<uint64_t> unary_ops;
+  std::atomic<uint64_t> unary_bits;
+  std::atomic<uint64_t> allocations;
+  std::atomic<uint64_t> allocated_bytes;
+  std::atomic<uint64_t> range_copies;
+  std::atomic<uint64_t> copied_bits;
+};
+
+inline bitset_stats_counters bitset_counters;
+
+#define BITSET_STATS_ADD(counter, value) bitset_counters.counter.fetch_add((value), std::memory_order_relaxed)
+
+#else
+
+#define BITSET_STATS_ADD(counter, value) static_cast<void>(0)
+
+#endif
+
+#if defined(BITSET_ENABLE_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BITSET_PROBE1(name, arg) DTRACE_PROBE1(bitset, name, arg)
+#define BITSET_PROBE2(name, arg1, arg2) DTRACE_PROBE2(bitset, name, arg1, arg2)
+#endif
+#endif
+
+#ifndef BITSET_PROBE1
+#define BITSET_PROBE1(name, arg) static_cast<void>(0)
+#define BITSET_PROBE2(name, arg1, arg2) static_cast<void>(0)
+#endif
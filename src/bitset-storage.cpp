@@ -0,0 +1,143 @@
+#include "bitset-storage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define BITSET_MAP_LARGE
+#endif
+
+namespace {
+
+constexpr std::size_t PAGE_SIZE = 4096;
+
+std::atomic<std::size_t> alignment{bitset_allocation_policy().alignment};
+std::atomic<std::size_t> huge_page_threshold{bitset_allocation_policy().huge_page_threshold};
+std::atomic<bool> prefault{bitset_allocation_policy().prefault};
+
+void* aligned_allocate(std::size_t bytes, std::size_t align) {
+#if defined(_WIN32)
+  return _aligned_malloc(bytes, align);
+#else
+  // `aligned_alloc` requires the size to be a multiple of the alignment
+  return std::aligned_alloc(align, (bytes + align - 1) / align * align);
+#endif
+}
+
+std::size_t page_round(std::size_t bytes) {
+  return (bytes + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+// Depends only on the size, so that deallocation takes the same path
+bool is_mapped(std::size_t bytes) {
+#if defined(BITSET_MAP_LARGE)
+  return bytes >= bitset_allocation_policy::MAP_THRESHOLD;
+#else
+  static_cast<void>(bytes);
+  return false;
+#endif
+}
+
+void* map_pages(std::size_t bytes, std::size_t align) {
+#if defined(BITSET_MAP_LARGE)
+  bytes = page_round(bytes);
+  // Pages are aligned already; for a larger alignment map more and unmap both ends
+  std::size_t extra = align > PAGE_SIZE ? align : 0;
+  void* data = mmap(nullptr, bytes + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+  auto first = reinterpret_cast<std::uintptr_t>(data);
+  auto last = first + bytes + extra;
+  auto aligned = (first + align - 1) / align * align;
+  if (aligned > first) {
+    munmap(data, aligned - first);
+  }
+  if (last > aligned + bytes) {
+    munmap(reinterpret_cast<void*>(aligned + bytes), last - aligned - bytes);
+  }
+  return reinterpret_cast<void*>(aligned);
+#else
+  static_cast<void>(bytes);
+  static_cast<void>(align);
+  return nullptr;
+#endif
+}
+
+} // namespace
+
+bitset_allocation_policy get_bitset_allocation_policy() {
+  bitset_allocation_policy res;
+  res.alignment = alignment.load(std::memory_order_relaxed);
+  res.huge_page_threshold = huge_page_threshold.load(std::memory_order_relaxed);
+  res.prefault = prefault.load(std::memory_order_relaxed);
+  return res;
+}
+
+void set_bitset_allocation_policy(const bitset_allocation_policy& policy) {
+  assert(policy.alignment >= alignof(uint64_t) && (policy.alignment & (policy.alignment - 1)) == 0);
+  alignment.store(policy.alignment, std::memory_order_relaxed);
+  huge_page_threshold.store(policy.huge_page_threshold, std::memory_order_relaxed);
+  prefault.store(policy.prefault, std::memory_order_relaxed);
+}
+
+uint64_t* allocate_bitset_words(std::size_t count, bool zeroed) {
+  std::size_t bytes = count * sizeof(uint64_t);
+  std::size_t align = alignment.load(std::memory_order_relaxed);
+  std::size_t threshold = huge_page_threshold.load(std::memory_order_relaxed);
+  // Smaller allocations would be padded to a whole huge page
+  bool huge = threshold != 0 && bytes >= std::max(threshold, bitset_allocation_policy::HUGE_PAGE_SIZE);
+  if (huge) {
+    align = bitset_allocation_policy::HUGE_PAGE_SIZE;
+  }
+
+  bool mapped = is_mapped(bytes);
+  void* data = mapped ? map_pages(bytes, align) : aligned_allocate(bytes, align);
+  if (data == nullptr) {
+    throw std::bad_alloc();
+  }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (huge) {
+    // Only a hint: fails harmlessly if transparent huge pages are disabled
+    madvise(data, mapped ? page_round(bytes) : (bytes + align - 1) / align * align, MADV_HUGEPAGE);
+  }
+#endif
+  if (zeroed && !mapped) {
+    std::memset(data, 0, bytes);
+  }
+  if (prefault.load(std::memory_order_relaxed)) {
+    auto* bytes_data = static_cast<volatile unsigned char*>(data);
+    for (std::size_t i = 0; i < bytes; i += PAGE_SIZE) {
+      bytes_data[i] = 0;
+    }
+  }
+  return static_cast<uint64_t*>(data);
+}
+
+void deallocate_bitset_words(uint64_t* data, std::size_t count) {
+  if (data == nullptr) {
+    return;
+  }
+#if defined(BITSET_MAP_LARGE)
+  if (std::size_t bytes = count * sizeof(uint64_t); is_mapped(bytes)) {
+    munmap(data, page_round(bytes));
+    return;
+  }
+#endif
+#if defined(_WIN32)
+  static_cast<void>(count);
+  _aligned_free(data);
+#else
+  std::free(data);
+#endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Process-wide policy for the word storage of every `bitset`
+struct bitset_allocation_policy {
+  // In bytes; a power of two, at least `alignof(uint64_t)`. 64 keeps words of a cache line together.
+  std::size_t alignment = 64;
+  // Allocations of at least this many bytes, and at least `HUGE_PAGE_SIZE`, are aligned to
+  // `HUGE_PAGE_SIZE` and advised to be backed by transparent huge pages (Linux only); 0 disables
+  std::size_t huge_page_threshold = 0;
+  // Touch every page right after allocation instead of on first use
+  bool prefault = false;
+
+  static constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+  // Allocations of at least this many bytes are mapped straight from the OS (POSIX only), so
+  // zeroed storage comes from zero pages that are only materialized when touched
+  static constexpr std::size_t MAP_THRESHOLD = std::size_t(1) << 20;
+};
+
+bitset_allocation_policy get_bitset_allocation_policy();
+void set_bitset_allocation_policy(const bitset_allocation_policy& policy);
+
+// Storage for `count` words according to the current policy, throws `std::bad_alloc` on failure.
+// `zeroed` storage is all zeros, without a pass over it when it is mapped from the OS.
+// Any pointer returned here can be released regardless of later policy changes;
+// `count` must be the same as at allocation.
+uint64_t* allocate_bitset_words(std::size_t count, bool zeroed = false);
+void deallocate_bitset_words(uint64_t* data, std::size_t count);
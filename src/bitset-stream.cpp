@@ -0,0 +1,317 @@
+#include "bitset-stream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr std::size_t WORD_BYTES = sizeof(word_type);
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+// Buffer and file offset alignment required by `O_DIRECT`
+constexpr std::size_t DIRECT_ALIGNMENT = 4096;
+
+[[noreturn]] void throw_io_error(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+void store_le(std::byte* out, uint64_t value) {
+  for (std::size_t i = 0; i < WORD_BYTES; ++i) {
+    out[i] = static_cast<std::byte>(value >> (8 * i));
+  }
+}
+
+uint64_t load_le(const std::byte* in) {
+  uint64_t res = 0;
+  for (std::size_t i = 0; i < WORD_BYTES; ++i) {
+    res |= std::to_integer<uint64_t>(in[i]) << (8 * i);
+  }
+  return res;
+}
+
+} // namespace
+
+// bitset_stream_writer
+
+bitset_stream_writer::bitset_stream_writer(const std::string& path, io_mode mode)
+    : _buffer(static_cast<std::byte*>(::operator new(BUFFER_SIZE, std::align_val_t(DIRECT_ALIGNMENT)))) {
+#if defined(__linux__) && defined(O_DIRECT)
+  if (mode == io_mode::direct) {
+    _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    // File systems without `O_DIRECT` support (e.g. tmpfs) reject it with `EINVAL`
+    if (_fd < 0 && errno != EINVAL) {
+      ::operator delete(_buffer, std::align_val_t(DIRECT_ALIGNMENT));
+      throw_io_error("bitset_stream_writer: open");
+    }
+  }
+#else
+  static_cast<void>(mode);
+#endif
+  if (_fd < 0) {
+    _file = std::fopen(path.c_str(), "wb");
+    if (_file == nullptr) {
+      ::operator delete(_buffer, std::align_val_t(DIRECT_ALIGNMENT));
+      throw_io_error("bitset_stream_writer: open");
+    }
+    // Writes are already batched in `_buffer`
+    std::setvbuf(_file, nullptr, _IONBF, 0);
+  }
+}
+
+bitset_stream_writer::~bitset_stream_writer() {
+  try {
+    close();
+  } catch (...) {}
+  ::operator delete(_buffer, std::align_val_t(DIRECT_ALIGNMENT));
+}
+
+void bitset_stream_writer::push_back(bool value) {
+  append_word(value ? ~(ALL_ONE >> 1) : 0, 1);
+}
+
+void bitset_stream_writer::append_word(word_type word, std::size_t count) {
+  assert(!_closed && count <= INT_SIZE);
+  if (count == 0) {
+    return;
+  }
+  word &= ALL_ONE << (INT_SIZE - count);
+  _word |= word >> _word_bits;
+  _size += count;
+  if (_word_bits + count < INT_SIZE) {
+    _word_bits += count;
+    return;
+  }
+  put_word(_word);
+  std::size_t used = INT_SIZE - _word_bits;
+  _word = used == INT_SIZE ? 0 : word << used;
+  _word_bits = _word_bits + count - INT_SIZE;
+}
+
+void bitset_stream_writer::append(const const_view& bits) {
+  for (std::size_t pos = 0; pos < bits.size(); pos += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, bits.size() - pos);
+    append_word(bits.read_word(pos, count), count);
+  }
+}
+
+std::size_t bitset_stream_writer::size() const {
+  return _size;
+}
+
+void bitset_stream_writer::close() {
+  if (_closed) {
+    return;
+  }
+  // The handle is released even if the final writes fail
+  std::exception_ptr error;
+  try {
+    if (_word_bits > 0) {
+      put_word(_word);
+    }
+    if (_buffer_size == BUFFER_SIZE) {
+      flush_buffer(false);
+    }
+    store_le(_buffer + _buffer_size, _size);
+    _buffer_size += WORD_BYTES;
+    flush_buffer(true);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  bool failed = false;
+#if defined(__linux__)
+  if (_fd >= 0) {
+    failed = ::close(_fd) != 0;
+    _fd = -1;
+  }
+#endif
+  if (_file != nullptr) {
+    failed = std::fclose(_file) != 0;
+    _file = nullptr;
+  }
+  _closed = true;
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if (failed) {
+    throw_io_error("bitset_stream_writer: close");
+  }
+}
+
+void bitset_stream_writer::put_word(word_type word) {
+  if (_buffer_size == BUFFER_SIZE) {
+    flush_buffer(false);
+  }
+  store_le(_buffer + _buffer_size, word);
+  _buffer_size += WORD_BYTES;
+}
+
+void bitset_stream_writer::flush_buffer(bool last) {
+#if defined(__linux__)
+  if (_fd >= 0) {
+    // `O_DIRECT` writes whole aligned blocks; the padding of the last one is truncated away
+    std::size_t padded = (_buffer_size + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+    std::memset(_buffer + _buffer_size, 0, padded - _buffer_size);
+    for (std::size_t done = 0; done < padded;) {
+      ssize_t res = ::write(_fd, _buffer + done, padded - done);
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw_io_error("bitset_stream_writer: write");
+      }
+      done += res;
+    }
+    _written += _buffer_size;
+    _buffer_size = 0;
+    if (last && ::ftruncate(_fd, static_cast<off_t>(_written)) != 0) {
+      throw_io_error("bitset_stream_writer: truncate");
+    }
+    return;
+  }
+#endif
+  static_cast<void>(last);
+  if (std::fwrite(_buffer, 1, _buffer_size, _file) != _buffer_size) {
+    throw_io_error("bitset_stream_writer: write");
+  }
+  _written += _buffer_size;
+  _buffer_size = 0;
+}
+
+// bitset_stream_reader
+
+bitset_stream_reader::bitset_stream_reader(const std::string& path, std::size_t window_size)
+    : _window_size(window_size)
+    , _file(std::fopen(path.c_str(), "rb")) {
+  assert(window_size > 0 && window_size % INT_SIZE == 0);
+  if (_file == nullptr) {
+    throw_io_error("bitset_stream_reader: open");
+  }
+  _worker = std::thread(&bitset_stream_reader::read_ahead, this);
+}
+
+bitset_stream_reader::~bitset_stream_reader() {
+  {
+    std::lock_guard lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  _worker.join();
+  std::fclose(_file);
+}
+
+bool bitset_stream_reader::next() {
+  std::unique_lock lock(_mutex);
+  _cv.wait(lock, [this] { return _ready || _finished || _error; });
+  if (_error) {
+    std::rethrow_exception(_error);
+  }
+  if (!_ready) {
+    return false;
+  }
+  if (_started) {
+    _position += _current.size();
+  }
+  _started = true;
+  _current.swap(_next);
+  _ready = false;
+  lock.unlock();
+  _cv.notify_all();
+  return true;
+}
+
+bitset_stream_reader::const_view bitset_stream_reader::window() const {
+  return _current;
+}
+
+std::size_t bitset_stream_reader::position() const {
+  return _position;
+}
+
+void bitset_stream_reader::read_ahead() {
+  std::size_t window_bytes = _window_size / CHAR_BIT;
+  // Reading one word and one byte past the window tells whether the window is the last one:
+  // the final word of the stream is the size, not data
+  std::vector<std::byte> buffer(window_bytes + WORD_BYTES + 1);
+  std::size_t carry = 0;
+  uint64_t bits_read = 0;
+  bitset decoded;
+
+  try {
+    while (true) {
+      std::size_t filled = carry + std::fread(buffer.data() + carry, 1, buffer.size() - carry, _file);
+      if (std::ferror(_file)) {
+        throw_io_error("bitset_stream_reader: read");
+      }
+
+      std::size_t data_bytes = window_bytes;
+      std::size_t bits = _window_size;
+      bool last = filled < buffer.size();
+      if (last) {
+        if (filled < WORD_BYTES) {
+          throw std::invalid_argument("bitset_stream_reader: truncated stream");
+        }
+        data_bytes = filled - WORD_BYTES;
+        uint64_t total = load_le(buffer.data() + data_bytes);
+        if (total < bits_read || data_bytes != (total - bits_read + INT_SIZE - 1) / INT_SIZE * WORD_BYTES) {
+          throw std::invalid_argument("bitset_stream_reader: size does not match the data");
+        }
+        bits = total - bits_read;
+      }
+
+      if (bits > 0) {
+        if (decoded.size() != bits) {
+          // Every word is stored below
+          decoded = bitset::uninitialized(bits);
+        }
+        for (std::size_t word = 0; word < decoded.word_count(); ++word) {
+          decoded.store_word(word, load_le(buffer.data() + word * WORD_BYTES));
+        }
+        bits_read += bits;
+
+        std::unique_lock lock(_mutex);
+        _cv.wait(lock, [this] { return !_ready || _stop; });
+        if (_stop) {
+          return;
+        }
+        // Hand the window over and take back the storage of the previous one
+        _next.swap(decoded);
+        _ready = true;
+        lock.unlock();
+        _cv.notify_all();
+      }
+
+      if (last) {
+        break;
+      }
+      carry = filled - window_bytes;
+      std::memmove(buffer.data(), buffer.data() + window_bytes, carry);
+    }
+  } catch (...) {
+    std::lock_guard lock(_mutex);
+    _error = std::current_exception();
+    _cv.notify_all();
+    return;
+  }
+
+  std::lock_guard lock(_mutex);
+  _finished = true;
+  _cv.notify_all();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Streaming I/O of bitsets that do not fit in memory. Stream format: the words of the bitset
+// as little-endian 64-bit integers (bits after the end are zero), followed by the size in bits
+// as a little-endian 64-bit integer. Keeping the size at the end lets the writer produce
+// a stream of unknown length, e.g. into a pipe.
+//
+// I/O errors are reported with `std::system_error`, malformed streams with `std::invalid_argument`.
+
+class bitset_stream_writer {
+public:
+  using word_type = bitset::word_type;
+  using const_view = bitset::const_view;
+
+  enum class io_mode : uint8_t {
+    buffered,
+    // `O_DIRECT` on Linux where the file system supports it, `buffered` otherwise
+    direct,
+  };
+
+  // Bytes collected before every write; a multiple of the `O_DIRECT` alignment
+  static constexpr std::size_t BUFFER_SIZE = std::size_t(1) << 20;
+
+  explicit bitset_stream_writer(const std::string& path, io_mode mode = io_mode::buffered);
+
+  bitset_stream_writer(const bitset_stream_writer&) = delete;
+  bitset_stream_writer& operator=(const bitset_stream_writer&) = delete;
+
+  // Closes the stream, ignoring errors; call `close()` to observe them
+  ~bitset_stream_writer();
+
+  void push_back(bool value);
+  // Appends the `count` most significant bits of `word`
+  void append_word(word_type word, std::size_t count);
+  void append(const const_view& bits);
+
+  std::size_t size() const;
+
+  // Writes the remaining bits and the size; the file is closed even if this throws
+  void close();
+
+private:
+  std::size_t _size = 0;
+  // Bits not yet forming a whole word, most significant first
+  word_type _word = 0;
+  std::size_t _word_bits = 0;
+
+  std::byte* _buffer;
+  std::size_t _buffer_size = 0;
+  uint64_t _written = 0;
+
+  std::FILE* _file = nullptr;
+  int _fd = -1;
+  bool _closed = false;
+
+  void put_word(word_type word);
+  void flush_buffer(bool last);
+};
+
+// Reads a stream as successive windows of `window_size` bits (the last one may be shorter).
+// The next window is read and decoded by a background thread while the current one is in use.
+// Memory does not depend on the stream length: the current window, the one handed over, the one
+// being decoded and a read buffer of about one window.
+class bitset_stream_reader {
+public:
+  using word_type = bitset::word_type;
+  using const_view = bitset::const_view;
+
+  // `window_size` is a positive multiple of 64
+  bitset_stream_reader(const std::string& path, std::size_t window_size);
+
+  bitset_stream_reader(const bitset_stream_reader&) = delete;
+  bitset_stream_reader& operator=(const bitset_stream_reader&) = delete;
+
+  ~bitset_stream_reader();
+
+  // Makes the next window current; `false` when the stream is over
+  bool next();
+
+  const_view window() const;
+  // Index of the first bit of the current window in the stream
+  std::size_t position() const;
+
+private:
+  std::size_t _window_size;
+  std::FILE* _file;
+
+  bitset _current;
+  std::size_t _position = 0;
+  bool _started = false;
+
+  // Shared with the read-ahead thread
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bitset _next;
+  bool _ready = false;
+  bool _finished = false;
+  bool _stop = false;
+  std::exception_ptr _error;
+
+  std::thread _worker;
+
+  void read_ahead();
+};
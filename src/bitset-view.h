@@ -1,28 +1,33 @@
 #pragma once
 
 #include "bitset-iterator.h"
+#include "bitset-stats.h"
 
 #include <algorithm>
 #include <bit>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <sstream>
 
-template <typename T>
+// `Order` is the order of bits in the words: views of `bitset` are `msb_first`, while an
+// `lsb_first` view can wrap external LSB-first bitmaps (e.g. Arrow validity buffers on
+// little-endian hosts) without conversion. Binary operations take views of the same order.
+template <typename T, bit_order Order = bit_order::msb_first>
 class bitset_view {
 public:
   using value_type = bool;
   using word_type = uint64_t;
 
-  using reference = bitset_reference<T>;
-  using const_reference = bitset_reference<const word_type>;
+  using reference = bitset_reference<T, Order>;
+  using const_reference = bitset_reference<const word_type, Order>;
 
-  using iterator = bitset_iterator<T>;
-  using const_iterator = bitset_iterator<const word_type>;
+  using iterator = bitset_iterator<T, Order>;
+  using const_iterator = bitset_iterator<const word_type, Order>;
 
-  using view = bitset_view<T>;
-  using const_view = bitset_view<const word_type>;
+  using view = bitset_view<T, Order>;
+  using const_view = bitset_view<const word_type, Order>;
 
   static constexpr std::size_t npos = -1;
 
@@ -33,13 +38,18 @@ public:
       : _begin(first)
       , _end(last) {}
 
+  // Bits [offset, offset + count) of the words at `data`
+  bitset_view(T* data, std::size_t offset, std::size_t count)
+      : _begin(const_cast<word_type*>(data), offset)
+      , _end(const_cast<word_type*>(data), offset + count) {}
+
   bitset_view(const bitset_view& other) = default;
 
   bitset_view& operator=(const bitset_view& other) = default;
 
   ~bitset_view() = default;
 
-  operator bitset_view<const word_type>() const {
+  operator bitset_view<const word_type, Order>() const {
     return {begin(), end()};
   }
 
@@ -81,11 +91,7 @@ public:
   }
 
   bitset_view flip() const {
-    apply_unary([](word_type& num, std::size_t offset, std::size_t count) {
-      word_type des = sub_bits(num, offset, count);
-      apply_bits(num, offset, count, ~des);
-      return true;
-    });
+    flip_range(begin()._cur, begin()._index, end()._index);
     return *this;
   }
 
@@ -118,6 +124,23 @@ public:
     return c;
   }
 
+  // Index of the first set bit at or after `pos`, or `npos` if there is none
+  std::size_t find_next(std::size_t pos) const {
+    while (pos < size()) {
+      std::size_t count = std::min(INT_SIZE, size() - pos);
+      word_type word = read_word(pos, count);
+      if (word != 0) {
+        return pos + traits::first_one(word);
+      }
+      pos += count;
+    }
+    return npos;
+  }
+
+  std::size_t find_first() const {
+    return find_next(0);
+  }
+
   friend void swap(bitset_view& lhs, bitset_view& rhs) {
     lhs.swap(rhs);
   }
@@ -133,67 +156,215 @@ public:
     return {begin() + offset, end()};
   }
 
-  friend bool operator==(const const_view& lhs, const const_view& rhs);
+  // Word-level access: `count` bits starting at `pos`, packed into the first positions of the
+  // word in the view's bit order (the high bits for `msb_first`, the low ones for `lsb_first`)
+  word_type read_word(std::size_t pos, std::size_t count = INT_SIZE) const {
+    if (count == 0) {
+      return 0;
+    }
+    std::size_t idx = begin()._index + pos;
+    const word_type* data = begin()._cur + idx / INT_SIZE;
+    std::size_t offset = idx % INT_SIZE;
+
+    word_type res = traits::to_front(data[0], offset);
+    if (offset + count > INT_SIZE) {
+      res |= traits::to_back(data[1], INT_SIZE - offset);
+    }
+    return res & traits::prefix(count);
+  }
+
+  void write_word(std::size_t pos, std::size_t count, word_type value) const {
+    if (count == 0) {
+      return;
+    }
+    std::size_t idx = begin()._index + pos;
+    T* data = begin()._cur + idx / INT_SIZE;
+    std::size_t offset = idx % INT_SIZE;
+
+    word_type mask = traits::prefix(count);
+    value &= mask;
+    data[0] = (data[0] & ~traits::to_back(mask, offset)) | traits::to_back(value, offset);
+    if (offset + count > INT_SIZE) {
+      std::size_t shift = INT_SIZE - offset;
+      data[1] = (data[1] & ~traits::to_front(mask, shift)) | traits::to_front(value, shift);
+    }
+  }
+
+  // Access by word index: word `index` holds bits [64 * index, 64 * index + 64), the last word
+  // fewer if the size is not a multiple of 64; they are packed the same way as in `read_word`
+  std::size_t word_count() const {
+    return (size() + INT_SIZE - 1) / INT_SIZE;
+  }
+
+  word_type load_word(std::size_t index) const {
+    std::size_t pos = index * INT_SIZE;
+    return read_word(pos, std::min(INT_SIZE, size() - pos));
+  }
+
+  void store_word(std::size_t index, word_type value) const {
+    std::size_t pos = index * INT_SIZE;
+    write_word(pos, std::min(INT_SIZE, size() - pos), value);
+  }
+
+  // Out-of-place kernels: bit `i` of this view becomes `op(lhs, rhs)` (`op(src)`) of bits `i`
+  // of the operands, in one pass over the words of this view. `op` must be bitwise. An operand
+  // may be this very range, which makes the operation in place, but must not overlap it otherwise.
+  template <class Function>
+  bitset_view transform(const const_view& lhs, const const_view& rhs, Function op) const {
+    assert(size() == lhs.size() && size() == rhs.size());
+    assert(same_or_disjoint(lhs) && same_or_disjoint(rhs));
+    BITSET_STATS_ADD(binary_ops, 1);
+    BITSET_STATS_ADD(binary_bits, size());
+    bool aligned = lhs.begin()._index % INT_SIZE == 0 && rhs.begin()._index % INT_SIZE == 0;
+    if (T* data = aligned_data(); data != nullptr && aligned) {
+      BITSET_STATS_ADD(aligned_binary_ops, 1);
+      const word_type* lhs_data = lhs.begin()._cur + lhs.begin()._index / INT_SIZE;
+      const word_type* rhs_data = rhs.begin()._cur + rhs.begin()._index / INT_SIZE;
+      std::size_t words = size() / INT_SIZE;
+      for (std::size_t i = 0; i < words; ++i) {
+        data[i] = op(lhs_data[i], rhs_data[i]);
+      }
+      std::size_t pos = words * INT_SIZE;
+      write_word(pos, size() - pos, op(lhs.read_word(pos, size() - pos), rhs.read_word(pos, size() - pos)));
+      return *this;
+    }
+    BITSET_STATS_ADD(misaligned_binary_ops, 1);
+    for_each_word([&](std::size_t pos, std::size_t count) {
+      return op(lhs.read_word(pos, count), rhs.read_word(pos, count));
+    });
+    return *this;
+  }
+
+  template <class Function>
+  bitset_view transform(const const_view& src, Function op) const {
+    assert(size() == src.size());
+    assert(same_or_disjoint(src));
+    BITSET_STATS_ADD(unary_ops, 1);
+    BITSET_STATS_ADD(unary_bits, size());
+    if (T* data = aligned_data(); data != nullptr && src.begin()._index % INT_SIZE == 0) {
+      const word_type* src_data = src.begin()._cur + src.begin()._index / INT_SIZE;
+      std::size_t words = size() / INT_SIZE;
+      for (std::size_t i = 0; i < words; ++i) {
+        data[i] = op(src_data[i]);
+      }
+      std::size_t pos = words * INT_SIZE;
+      write_word(pos, size() - pos, op(src.read_word(pos, size() - pos)));
+      return *this;
+    }
+    for_each_word([&](std::size_t pos, std::size_t count) { return op(src.read_word(pos, count)); });
+    return *this;
+  }
+
+  friend std::size_t first_mismatch(const bitset_view<const word_type>& lhs, const bitset_view<const word_type>& rhs);
+
+  friend class bitset;
 
 private:
+  using traits = bit_order_traits<Order>;
+
   iterator _begin;
   iterator _end;
 
-  static const std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+  static constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
   static constexpr word_type ALL_ONE = -1;
 
   bitset_view set_bits(bool value) const {
-    word_type mask = value ? mask_ones(INT_SIZE) : 0;
-    apply_unary([mask](word_type& num, std::size_t offset, std::size_t count) {
-      apply_bits(num, offset, count, first_bits(mask, count));
-      return true;
-    });
+    fill_range(begin()._cur, begin()._index, end()._index, value);
     return *this;
   }
 
-  static std::size_t count_bits(word_type num) {
-    return std::popcount(num);
+  // Range kernels over raw storage: partial words at the borders are masked, full words are written as a whole
+  static void fill_range(T* data, std::size_t first, std::size_t last, bool value) {
+    if (first >= last) {
+      return;
+    }
+    std::size_t first_word = first / INT_SIZE;
+    std::size_t last_word = (last - 1) / INT_SIZE;
+    word_type first_mask = traits::suffix(first % INT_SIZE);
+    word_type last_mask = traits::prefix((last - 1) % INT_SIZE + 1);
+
+    if (first_word == last_word) {
+      fill_mask(data[first_word], first_mask & last_mask, value);
+      return;
+    }
+    fill_mask(data[first_word], first_mask, value);
+    std::fill(data + first_word + 1, data + last_word, value ? ALL_ONE : 0);
+    fill_mask(data[last_word], last_mask, value);
   }
 
-  static word_type first_bits(word_type num, std::size_t count) {
-    if (count == 0) {
-      return 0;
+  static void flip_range(T* data, std::size_t first, std::size_t last) {
+    if (first >= last) {
+      return;
+    }
+    std::size_t first_word = first / INT_SIZE;
+    std::size_t last_word = (last - 1) / INT_SIZE;
+    word_type first_mask = traits::suffix(first % INT_SIZE);
+    word_type last_mask = traits::prefix((last - 1) % INT_SIZE + 1);
+
+    if (first_word == last_word) {
+      data[first_word] ^= first_mask & last_mask;
+      return;
     }
-    if (count == INT_SIZE) {
-      return num;
+    data[first_word] ^= first_mask;
+    for (std::size_t i = first_word + 1; i < last_word; ++i) {
+      data[i] = ~data[i];
     }
-    return num & mask_ones(count);
+    data[last_word] ^= last_mask;
+  }
+
+  static void fill_mask(T& num, word_type mask, bool value) {
+    if (value) {
+      num |= mask;
+    } else {
+      num &= ~mask;
+    }
+  }
+
+  static std::size_t count_bits(word_type num) {
+    return std::popcount(num);
   }
 
+  // Positions [offset, offset + count) of `num` as an integer
   static word_type sub_bits(word_type num, std::size_t offset, std::size_t count) {
-    word_type res = first_bits(num, INT_SIZE - offset);
-    res >>= (INT_SIZE - offset - count);
-    return res;
+    return traits::extract(num, offset, count);
   }
 
-  static word_type mask_ones(std::size_t count) {
-    if (count == 0) {
-      return 0;
-    }
-    return ALL_ONE >> (INT_SIZE - count);
+  static void apply_bits(word_type& num, std::size_t offset, std::size_t count, word_type source) {
+    traits::deposit(num, offset, count, source);
   }
 
-  static void clear_bits(word_type& num, std::size_t offset, std::size_t count) {
-    if (offset == 0 && count == INT_SIZE) {
-      num = 0;
-    } else {
-      word_type mask = mask_ones(count) << (INT_SIZE - offset - count);
-      num &= ~mask;
+  // Pointer to the first word, or `nullptr` if the view doesn't start on a word boundary
+  T* aligned_data() const {
+    if (begin()._index % INT_SIZE != 0) {
+      return nullptr;
     }
+    return begin()._cur + begin()._index / INT_SIZE;
   }
 
-  static void apply_bits(word_type& num, std::size_t offset, std::size_t count, word_type source) {
-    if (offset == 0 && count == INT_SIZE) {
-      num = source;
-    } else {
-      clear_bits(num, offset, count);
-      num |= first_bits(source, count) << (INT_SIZE - offset - count);
+  // Writes `word(pos, count)` over the view in chunks that end on word boundaries of the storage,
+  // so that every word of the view is written once and after its bits were read
+  template <class Function>
+  void for_each_word(Function word) const {
+    std::size_t pos = 0;
+    if (std::size_t offset = begin()._index % INT_SIZE; offset != 0) {
+      pos = std::min(size(), INT_SIZE - offset);
+      write_word(0, pos, word(0, pos));
+    }
+    T* data = begin()._cur + (begin()._index + pos) / INT_SIZE;
+    for (; pos + INT_SIZE <= size(); pos += INT_SIZE) {
+      *data++ = word(pos, INT_SIZE);
     }
+    write_word(pos, size() - pos, word(pos, size() - pos));
+  }
+
+  // Whether `other` is the same range as this view or shares no bits with it
+  bool same_or_disjoint(const const_view& other) const {
+    auto address = [](auto it) {
+      return reinterpret_cast<std::uintptr_t>(it._cur) / sizeof(word_type) * INT_SIZE + it._index;
+    };
+    std::size_t first = address(begin());
+    std::size_t other_first = address(other.begin());
+    return first == other_first || first + size() <= other_first || other_first + other.size() <= first;
   }
 
   static T& get_element(T* data, std::size_t idx) {
@@ -210,6 +381,16 @@ private:
     std::size_t other_idx = other.begin()._index;
     std::size_t border = end()._index;
 
+    bool aligned = idx % INT_SIZE == other_idx % INT_SIZE;
+    BITSET_STATS_ADD(binary_ops, 1);
+    BITSET_STATS_ADD(binary_bits, size());
+    if (aligned) {
+      BITSET_STATS_ADD(aligned_binary_ops, 1);
+    } else {
+      BITSET_STATS_ADD(misaligned_binary_ops, 1);
+    }
+    BITSET_PROBE2(binary_op, size(), aligned);
+
     while (idx < border) {
       std::size_t count = border - idx;
       std::size_t i = idx % INT_SIZE;
@@ -237,6 +418,10 @@ private:
     std::size_t idx = begin()._index;
     std::size_t border = end()._index;
 
+    BITSET_STATS_ADD(unary_ops, 1);
+    BITSET_STATS_ADD(unary_bits, size());
+    BITSET_PROBE1(unary_op, size());
+
     while (idx < border) {
       std::size_t i = idx % INT_SIZE;
       std::size_t count = std::min(border - idx, INT_SIZE - i);
@@ -1,17 +1,60 @@
 #include "bitset.h"
 
 #include "bitset-iterator.h"
+#include "bitset-storage.h"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstring>
 #include <sstream>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<bitset::word_type>::digits;
+constexpr bitset::word_type ALL_ONE = std::numeric_limits<bitset::word_type>::max();
+
+// Number of words compared with a single memcmp before looking for the exact mismatch
+constexpr std::size_t MISMATCH_BLOCK = 16;
+
+constexpr uint64_t HASH_SECRET[] = {0xa0761d6478bd642f, 0xe7037ed1a0b428db, 0x8ebc6af09c88c6e3, 0x589965cc75374cc3};
+
+// 64x64 -> 128 multiplication folded back to 64 bits, the mixing step of wyhash
+uint64_t hash_mum(uint64_t lhs, uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef unsigned __int128 uint128;
+  uint128 res = static_cast<uint128>(lhs) * rhs;
+  return static_cast<uint64_t>(res) ^ static_cast<uint64_t>(res >> 64);
+#else
+  uint64_t lhs_hi = lhs >> 32, lhs_lo = lhs & 0xffffffff;
+  uint64_t rhs_hi = rhs >> 32, rhs_lo = rhs & 0xffffffff;
+  uint64_t mid0 = lhs_hi * rhs_lo;
+  uint64_t mid1 = rhs_hi * lhs_lo;
+  uint64_t lo = lhs_lo * rhs_lo;
+  uint64_t tmp = lo + (mid0 << 32);
+  uint64_t carry = tmp < lo;
+  lo = tmp + (mid1 << 32);
+  carry += lo < tmp;
+  uint64_t hi = lhs_hi * rhs_hi + (mid0 >> 32) + (mid1 >> 32) + carry;
+  return lo ^ hi;
+#endif
+}
+
+} // namespace
 
 bitset::bitset()
     : bitset(0) {}
 
+// Zeros come from the allocator (zero pages for large bitsets), ones are written word by word
 bitset::bitset(std::size_t size, bool value)
-    : bitset(size) {
-  set_bit(value);
+    : _size(size)
+    , _capacity(get_capacity(size))
+    , _data(allocate(_capacity, !value)) {
+  if (value) {
+    std::fill_n(_data, _capacity, ALL_ONE);
+  }
 }
 
 bitset::bitset(const bitset& other)
@@ -20,6 +63,19 @@ bitset::bitset(const bitset& other)
 bitset::bitset(const_iterator first, const_iterator last)
     : bitset(first, last, 0) {}
 
+bitset bitset::uninitialized(std::size_t size) {
+  return bitset(size);
+}
+
+bitset bitset::filled(std::size_t size, word_type pattern) {
+  if (pattern == 0) {
+    return bitset(size, false);
+  }
+  bitset res(size);
+  std::fill_n(res._data, res._capacity, pattern);
+  return res;
+}
+
 bitset::bitset(std::string_view str)
     : bitset(str.size()) {
   std::transform(str.begin(), str.end(), begin(), [](char c) { return c == '1'; });
@@ -49,7 +105,7 @@ bitset& bitset::operator=(const const_view& other) & {
 }
 
 bitset::~bitset() {
-  delete[] _data;
+  deallocate_bitset_words(_data, _capacity);
 }
 
 std::size_t bitset::size() const {
@@ -61,11 +117,11 @@ bool bitset::empty() const {
 }
 
 bitset::reference bitset::operator[](std::size_t index) {
-  return begin()[index];
+  return {_data + index / INT_SIZE, index % INT_SIZE};
 }
 
 bitset::const_reference bitset::operator[](std::size_t index) const {
-  return begin()[index];
+  return {_data + index / INT_SIZE, index % INT_SIZE};
 }
 
 bitset::iterator bitset::begin() {
@@ -140,8 +196,96 @@ bitset& bitset::reset() & {
   return *this;
 }
 
-bitset& bitset::set_bit(bool value) {
-  return set_bit(begin(), end(), value);
+bitset& bitset::set(std::size_t first, std::size_t last, bool value) & {
+  assert(first <= last && last <= size());
+  view::fill_range(_data, first, last, value);
+  return *this;
+}
+
+bitset& bitset::reset(std::size_t first, std::size_t last) & {
+  return set(first, last, false);
+}
+
+bitset& bitset::flip(std::size_t first, std::size_t last) & {
+  assert(first <= last && last <= size());
+  view::flip_range(_data, first, last);
+  return *this;
+}
+
+bitset& bitset::set_indices(std::span<const std::size_t> indices) & {
+  // Sorted indices let every touched word be written once with a combined mask
+  std::vector<std::size_t> sorted;
+  if (!std::ranges::is_sorted(indices)) {
+    sorted.assign(indices.begin(), indices.end());
+    std::ranges::sort(sorted);
+    indices = sorted;
+  }
+
+  std::size_t i = 0;
+  while (i < indices.size()) {
+    std::size_t word = indices[i] / INT_SIZE;
+    word_type mask = 0;
+    for (; i < indices.size() && indices[i] / INT_SIZE == word; ++i) {
+      assert(indices[i] < size());
+      mask |= bit_mask(indices[i]);
+    }
+    _data[word] |= mask;
+  }
+  return *this;
+}
+
+bitset& bitset::insert(std::size_t pos, std::size_t count, bool value) & {
+  assert(pos <= size());
+  std::size_t old_size = size();
+  if (get_capacity(old_size + count) > _capacity) {
+    bitset bs(old_size + count);
+    move_bits(bs.subview(0, pos), std::as_const(*this).subview(0, pos));
+    move_bits(bs.subview(pos + count), std::as_const(*this).subview(pos));
+    swap(bs);
+  } else {
+    _size += count;
+    move_bits(subview(pos + count), std::as_const(*this).subview(pos, old_size - pos));
+  }
+  set_bit(begin() + pos, begin() + pos + count, value);
+  return *this;
+}
+
+bitset& bitset::insert(std::size_t pos, const const_view& other) & {
+  assert(pos <= size());
+  if (other.begin()._cur == _data && !other.empty()) {
+    bitset copy(other);
+    return insert(pos, copy);
+  }
+  std::size_t old_size = size();
+  std::size_t count = other.size();
+  if (get_capacity(old_size + count) > _capacity) {
+    bitset bs(old_size + count);
+    move_bits(bs.subview(0, pos), std::as_const(*this).subview(0, pos));
+    move_bits(bs.subview(pos, count), other);
+    move_bits(bs.subview(pos + count), std::as_const(*this).subview(pos));
+    swap(bs);
+  } else {
+    _size += count;
+    move_bits(subview(pos + count), std::as_const(*this).subview(pos, old_size - pos));
+    move_bits(subview(pos, count), other);
+  }
+  return *this;
+}
+
+bitset& bitset::erase(std::size_t pos, std::size_t count) & {
+  assert(pos <= size());
+  count = std::min(count, size() - pos);
+  std::size_t new_size = size() - count;
+  if (get_capacity(new_size) < _capacity) {
+    bitset bs(new_size);
+    move_bits(bs.subview(0, pos), std::as_const(*this).subview(0, pos));
+    move_bits(bs.subview(pos), std::as_const(*this).subview(pos + count));
+    swap(bs);
+  } else {
+    move_bits(subview(pos, new_size - pos), std::as_const(*this).subview(pos + count));
+    _size = new_size;
+  }
+  return *this;
 }
 
 bitset& bitset::set_bit(const iterator& first, const iterator& last, bool value) {
@@ -157,6 +301,42 @@ std::size_t bitset::get_capacity(std::size_t size) {
   return (size + bitset::INT_SIZE - 1) / bitset::INT_SIZE;
 }
 
+void bitset::move_bits(const view& dst, const const_view& src) {
+  assert(dst.size() == src.size());
+  std::size_t size = src.size();
+  // Ranges may overlap as with memmove: when moving towards the end, copy from the back
+  bool backward = dst.begin()._index > src.begin()._index;
+
+  word_type* dst_data = dst.aligned_data();
+  const word_type* src_data = src.aligned_data();
+  if (dst_data != nullptr && src_data != nullptr && size >= INT_SIZE) {
+    std::size_t words = size / INT_SIZE;
+    std::size_t tail = size % INT_SIZE;
+    if (backward) {
+      dst.write_word(words * INT_SIZE, tail, src.read_word(words * INT_SIZE, tail));
+    }
+    std::memmove(dst_data, src_data, words * sizeof(word_type));
+    if (!backward) {
+      dst.write_word(words * INT_SIZE, tail, src.read_word(words * INT_SIZE, tail));
+    }
+    return;
+  }
+
+  if (backward) {
+    std::size_t pos = size;
+    while (pos > 0) {
+      std::size_t count = std::min(pos, INT_SIZE);
+      pos -= count;
+      dst.write_word(pos, count, src.read_word(pos, count));
+    }
+  } else {
+    for (std::size_t pos = 0; pos < size; pos += INT_SIZE) {
+      std::size_t count = std::min(size - pos, INT_SIZE);
+      dst.write_word(pos, count, src.read_word(pos, count));
+    }
+  }
+}
+
 void bitset::swap(bitset& other) {
   std::swap(_size, other._size);
   std::swap(_capacity, other._capacity);
@@ -175,6 +355,14 @@ std::size_t bitset::count() const {
   return subview().count();
 }
 
+std::size_t bitset::find_first() const {
+  return subview().find_first();
+}
+
+std::size_t bitset::find_next(std::size_t pos) const {
+  return subview().find_next(pos);
+}
+
 bitset::operator const_view() const {
   return {begin(), end()};
 }
@@ -183,6 +371,22 @@ bitset::operator view() {
   return {begin(), end()};
 }
 
+bitset::word_type* bitset::data() {
+  return _data;
+}
+
+const bitset::word_type* bitset::data() const {
+  return _data;
+}
+
+std::span<bitset::word_type> bitset::words() {
+  return {_data, _capacity};
+}
+
+std::span<const bitset::word_type> bitset::words() const {
+  return {_data, _capacity};
+}
+
 bitset::view bitset::subview(std::size_t offset, std::size_t count) {
   if (offset > size()) {
     return {end(), end()};
@@ -207,70 +411,144 @@ bitset::const_view bitset::subview(std::size_t offset, std::size_t count) const
 
 bitset::bitset(const_iterator first, const_iterator last, std::size_t extra_size)
     : bitset(last - first + extra_size) {
-  std::transform(first, last, begin(), std::identity());
-  set_bit(end() - extra_size, end(), false);
+  BITSET_STATS_ADD(range_copies, 1);
+  BITSET_STATS_ADD(copied_bits, last - first);
+  BITSET_PROBE1(range_copy, last - first);
+  move_bits(subview(0, last - first), const_view(first, last));
+  // Only the words of the extra bits need clearing, the copied ones are written once
+  view::fill_range(_data, last - first, size(), false);
 }
 
 bitset::bitset(std::size_t size)
     : _size(size)
     , _capacity(get_capacity(_size))
-    , _data(nullptr) {
-  if (_capacity > 0) {
-    _data = new bitset::word_type[_capacity];
+    , _data(allocate(_capacity, false)) {}
+
+bitset::word_type* bitset::allocate(std::size_t capacity, bool zeroed) {
+  if (capacity == 0) {
+    return nullptr;
   }
+  BITSET_STATS_ADD(allocations, 1);
+  BITSET_STATS_ADD(allocated_bytes, capacity * sizeof(word_type));
+  BITSET_PROBE1(allocation, capacity * sizeof(word_type));
+  return allocate_bitset_words(capacity, zeroed);
 }
 
 bool operator==(const bitset::const_view& lhs, const bitset::const_view& rhs) {
-  return lhs.size() == rhs.size() &&
-         lhs.apply_binary(
-             rhs,
-             [](const bitset::word_type& num, std::size_t offset, std::size_t count, bitset::word_type source) {
-               bitset::word_type des = bitset::const_view::sub_bits(num, offset, count);
-               return des == source;
-             }
-         );
+  return lhs.size() == rhs.size() && first_mismatch(lhs, rhs) == bitset::npos;
 }
 
 bool operator!=(const bitset::const_view& lhs, const bitset::const_view& rhs) {
   return !(lhs == rhs);
 }
 
+std::strong_ordering operator<=>(const bitset::const_view& lhs, const bitset::const_view& rhs) {
+  std::size_t pos = first_mismatch(lhs, rhs);
+  if (pos == bitset::npos) {
+    return std::strong_ordering::equal;
+  }
+  if (pos == std::min(lhs.size(), rhs.size())) {
+    return lhs.size() <=> rhs.size();
+  }
+  return static_cast<bool>(lhs[pos]) <=> static_cast<bool>(rhs[pos]);
+}
+
+std::size_t first_mismatch(const bitset::const_view& lhs, const bitset::const_view& rhs) {
+  std::size_t size = std::min(lhs.size(), rhs.size());
+  std::size_t pos = 0;
+
+  const bitset::word_type* lhs_data = lhs.aligned_data();
+  const bitset::word_type* rhs_data = rhs.aligned_data();
+  if (lhs_data != nullptr && rhs_data != nullptr) {
+    std::size_t words = size / INT_SIZE;
+    std::size_t i = 0;
+    while (words - i >= MISMATCH_BLOCK &&
+           std::memcmp(lhs_data + i, rhs_data + i, MISMATCH_BLOCK * sizeof(bitset::word_type)) == 0) {
+      i += MISMATCH_BLOCK;
+    }
+    while (i < words && lhs_data[i] == rhs_data[i]) {
+      ++i;
+    }
+    pos = i * INT_SIZE;
+  }
+
+  for (; pos < size; pos += INT_SIZE) {
+    std::size_t count = std::min(INT_SIZE, size - pos);
+    bitset::word_type diff = lhs.read_word(pos, count) ^ rhs.read_word(pos, count);
+    if (diff != 0) {
+      return pos + std::countl_zero(diff);
+    }
+  }
+  return lhs.size() == rhs.size() ? bitset::npos : size;
+}
+
 bitset operator&(const bitset::const_view& left, const bitset::const_view& right) {
-  bitset bs(left);
-  bs &= right;
+  bitset bs = bitset::uninitialized(left.size());
+  bitwise_and(bs, left, right);
   return bs;
 }
 
 bitset operator|(const bitset::const_view& left, const bitset::const_view& right) {
-  bitset bs(left);
-  bs |= right;
+  bitset bs = bitset::uninitialized(left.size());
+  bitwise_or(bs, left, right);
   return bs;
 }
 
 bitset operator^(const bitset::const_view& left, const bitset::const_view& right) {
-  bitset bs(left);
-  bs ^= right;
+  bitset bs = bitset::uninitialized(left.size());
+  bitwise_xor(bs, left, right);
   return bs;
 }
 
 bitset operator~(const bitset::const_view& bs_view) {
-  bitset bs(bs_view);
-  bs.flip();
+  bitset bs = bitset::uninitialized(bs_view.size());
+  bitwise_not(bs, bs_view);
   return bs;
 }
 
 bitset operator<<(const bitset::const_view& bs_view, std::size_t count) {
-  bitset bs(bs_view);
-  bs <<= count;
+  bitset bs = bitset::uninitialized(bs_view.size() + count);
+  shift_left(bs, bs_view, count);
   return bs;
 }
 
 bitset operator>>(const bitset::const_view& bs_view, std::size_t count) {
-  bitset bs(bs_view);
-  bs >>= count;
+  bitset bs = bitset::uninitialized(bs_view.size() - std::min(count, bs_view.size()));
+  shift_right(bs, bs_view, count);
   return bs;
 }
 
+void bitwise_and(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right) {
+  dst.transform(left, right, [](bitset::word_type lhs, bitset::word_type rhs) { return lhs & rhs; });
+}
+
+void bitwise_or(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right) {
+  dst.transform(left, right, [](bitset::word_type lhs, bitset::word_type rhs) { return lhs | rhs; });
+}
+
+void bitwise_xor(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right) {
+  dst.transform(left, right, [](bitset::word_type lhs, bitset::word_type rhs) { return lhs ^ rhs; });
+}
+
+void bitwise_andnot(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right) {
+  dst.transform(left, right, [](bitset::word_type lhs, bitset::word_type rhs) { return lhs & ~rhs; });
+}
+
+void bitwise_not(const bitset::view& dst, const bitset::const_view& src) {
+  dst.transform(src, [](bitset::word_type word) { return ~word; });
+}
+
+void shift_left(const bitset::view& dst, const bitset::const_view& src, std::size_t count) {
+  assert(dst.size() == src.size() + count);
+  dst.subview(0, src.size()).transform(src, [](bitset::word_type word) { return word; });
+  dst.subview(src.size()).reset();
+}
+
+void shift_right(const bitset::view& dst, const bitset::const_view& src, std::size_t count) {
+  assert(dst.size() == src.size() - std::min(count, src.size()));
+  dst.transform(src.subview(0, dst.size()), [](bitset::word_type word) { return word; });
+}
+
 std::ostream& operator<<(std::ostream& out, const bitset::const_view& bs) {
   for (auto el : bs) {
     out << el;
@@ -290,3 +568,29 @@ std::string to_string(const bitset::const_view& bs_view) {
 void swap(bitset& lhs, bitset& rhs) {
   lhs.swap(rhs);
 }
+
+std::size_t std::hash<bitset::const_view>::operator()(const bitset::const_view& bs_view) const noexcept {
+  // Words are read relative to the view, so equal views hash equally regardless of their offset
+  std::size_t size = bs_view.size();
+  uint64_t seed = hash_mum(size ^ HASH_SECRET[0], HASH_SECRET[1]);
+
+  std::size_t pos = 0;
+  for (; pos + 2 * INT_SIZE <= size; pos += 2 * INT_SIZE) {
+    seed = hash_mum(bs_view.read_word(pos) ^ HASH_SECRET[1], bs_view.read_word(pos + INT_SIZE) ^ seed);
+  }
+  if (pos < size) {
+    std::size_t count = std::min(INT_SIZE, size - pos);
+    uint64_t first = bs_view.read_word(pos, count);
+    uint64_t second = pos + count < size ? bs_view.read_word(pos + count, size - pos - count) : 0;
+    seed = hash_mum(first ^ HASH_SECRET[2], second ^ seed ^ HASH_SECRET[3]);
+  }
+  return hash_mum(seed ^ HASH_SECRET[0], size ^ HASH_SECRET[3]);
+}
+
+std::size_t std::hash<bitset::view>::operator()(const bitset::view& bs_view) const noexcept {
+  return std::hash<bitset::const_view>()(bs_view);
+}
+
+std::size_t std::hash<bitset>::operator()(const bitset& bs) const noexcept {
+  return std::hash<bitset::const_view>()(bs);
+}
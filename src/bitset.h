@@ -3,11 +3,18 @@
 #include "bitset-iterator.h"
 #include "bitset-view.h"
 
+#include <bit>
+#include <cassert>
+#include <compare>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <span>
 #include <string_view>
+#include <vector>
+
+class xoshiro256;
 
 class bitset {
 public:
@@ -32,6 +39,13 @@ public:
   explicit bitset(const const_view& other);
   bitset(const_iterator first, const_iterator last);
 
+  // Contents are unspecified: for callers that write every bit before reading it
+  static bitset uninitialized(std::size_t size);
+  // `pattern` repeated every 64 bits, most significant bit first
+  static bitset filled(std::size_t size, word_type pattern);
+  // Independent bits equal to 1 with probability `density`, see `bitset-random.h`
+  static bitset random(std::size_t size, xoshiro256& rng, double density = 0.5, std::size_t threads = 0);
+
   bitset& operator=(const bitset& other) &;
   bitset& operator=(std::string_view str) &;
   bitset& operator=(const const_view& other) &;
@@ -62,16 +76,63 @@ public:
   bitset& set() &;
   bitset& reset() &;
 
+  bool test(std::size_t pos) const;
+  bitset& set(std::size_t pos) &;
+  bitset& reset(std::size_t pos) &;
+  bitset& flip(std::size_t pos) &;
+
+  bitset& set(std::size_t first, std::size_t last, bool value) &;
+  bitset& reset(std::size_t first, std::size_t last) &;
+  bitset& flip(std::size_t first, std::size_t last) &;
+
+  bitset& set_indices(std::span<const std::size_t> indices) &;
+
+  bitset& insert(std::size_t pos, std::size_t count, bool value) &;
+  bitset& insert(std::size_t pos, const const_view& other) &;
+  bitset& erase(std::size_t pos, std::size_t count = npos) &;
+
   bool all() const;
   bool any() const;
   std::size_t count() const;
 
+  std::size_t find_first() const;
+  std::size_t find_next(std::size_t pos) const;
+
   operator const_view() const;
   operator view();
 
   view subview(std::size_t offset = 0, std::size_t count = npos);
   const_view subview(std::size_t offset = 0, std::size_t count = npos) const;
 
+  // The storage, `msb_first` words; bits after `size()` in the last word are unspecified
+  // and may be freely overwritten
+  word_type* data();
+  const word_type* data() const;
+  std::span<word_type> words();
+  std::span<const word_type> words() const;
+
+  // Word access by index as in `bitset_view::load_word`: bits after `size()` read as zeros
+  std::size_t word_count() const;
+  word_type load_word(std::size_t index) const;
+  void store_word(std::size_t index, word_type value);
+
+  // Conversions from and to external bitmaps of `size` bits; `words` and `bytes` hold at least
+  // as many whole words (bytes) as the bits occupy. Bits after `size()` are written as zeros.
+  static bitset from_words(
+      std::span<const word_type> words,
+      std::size_t size,
+      bit_order order = bit_order::msb_first,
+      std::endian byte_order = std::endian::native
+  );
+  static bitset from_bytes(std::span<const std::byte> bytes, std::size_t size, bit_order order = bit_order::msb_first);
+  void to_words(
+      std::span<word_type> out,
+      bit_order order = bit_order::msb_first,
+      std::endian byte_order = std::endian::native
+  ) const;
+  void to_bytes(std::span<std::byte> out, bit_order order = bit_order::msb_first) const;
+  std::vector<std::byte> to_bytes(bit_order order = bit_order::msb_first) const;
+
 private:
   size_t _size;
   size_t _capacity;
@@ -81,16 +142,70 @@ private:
 
   explicit bitset(std::size_t size);
 
-  bitset& set_bit(bool value);
+  // Reads snapshots straight into uninitialized storage and writes them from it
+  friend class bitset_loader;
+
   bitset& set_bit(const iterator& first, const iterator& last, bool value);
 
-  static const std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+  static constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
 
   static std::size_t get_capacity(std::size_t size);
+  static word_type* allocate(std::size_t capacity, bool zeroed);
+
+  static void move_bits(const view& dst, const const_view& src);
+
+  static word_type bit_mask(std::size_t pos);
 };
 
+// Single-bit and word access is defined here so that it can be inlined into callers
+
+inline bitset::word_type bitset::bit_mask(std::size_t pos) {
+  return word_type(1) << (INT_SIZE - 1 - pos % INT_SIZE);
+}
+
+inline std::size_t bitset::word_count() const {
+  return get_capacity(size());
+}
+
+inline bitset::word_type bitset::load_word(std::size_t index) const {
+  assert(index < word_count());
+  std::size_t rest = size() - index * INT_SIZE;
+  return rest >= INT_SIZE ? _data[index] : _data[index] & ~(~word_type(0) >> rest);
+}
+
+inline void bitset::store_word(std::size_t index, word_type value) {
+  assert(index < word_count());
+  _data[index] = value;
+}
+
+inline bool bitset::test(std::size_t pos) const {
+  assert(pos < size());
+  return (_data[pos / INT_SIZE] & bit_mask(pos)) != 0;
+}
+
+inline bitset& bitset::set(std::size_t pos) & {
+  assert(pos < size());
+  _data[pos / INT_SIZE] |= bit_mask(pos);
+  return *this;
+}
+
+inline bitset& bitset::reset(std::size_t pos) & {
+  assert(pos < size());
+  _data[pos / INT_SIZE] &= ~bit_mask(pos);
+  return *this;
+}
+
+inline bitset& bitset::flip(std::size_t pos) & {
+  assert(pos < size());
+  _data[pos / INT_SIZE] ^= bit_mask(pos);
+  return *this;
+}
+
 bool operator==(const bitset::const_view& lhs, const bitset::const_view& rhs);
 bool operator!=(const bitset::const_view& lhs, const bitset::const_view& rhs);
+std::strong_ordering operator<=>(const bitset::const_view& lhs, const bitset::const_view& rhs);
+
+std::size_t first_mismatch(const bitset::const_view& lhs, const bitset::const_view& rhs);
 
 bitset operator&(const bitset::const_view& left, const bitset::const_view& right);
 bitset operator|(const bitset::const_view& left, const bitset::const_view& right);
@@ -99,8 +214,37 @@ bitset operator~(const bitset::const_view& bs_view);
 bitset operator<<(const bitset::const_view& bs_view, std::size_t count);
 bitset operator>>(const bitset::const_view& bs_view, std::size_t count);
 
+// Out-of-place counterparts of the operators: the result is written into `dst` in one pass,
+// without allocating. `dst` must have the size of the result; an operand may be the same range
+// as `dst` (or its first `size()` bits for the shifts) but must not overlap it otherwise.
+void bitwise_and(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right);
+void bitwise_or(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right);
+void bitwise_xor(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right);
+// `left & ~right`
+void bitwise_andnot(const bitset::view& dst, const bitset::const_view& left, const bitset::const_view& right);
+void bitwise_not(const bitset::view& dst, const bitset::const_view& src);
+// `dst.size()` is `src.size() + count`
+void shift_left(const bitset::view& dst, const bitset::const_view& src, std::size_t count);
+// `dst.size()` is `src.size() - count`, or 0 if `count` is larger
+void shift_right(const bitset::view& dst, const bitset::const_view& src, std::size_t count);
+
 std::ostream& operator<<(std::ostream& out, const bitset::const_view& bs);
 
 std::string to_string(const bitset::const_view& bs_view);
 
 void swap(bitset& lhs, bitset& rhs);
+
+template <>
+struct std::hash<bitset::const_view> {
+  std::size_t operator()(const bitset::const_view& bs_view) const noexcept;
+};
+
+template <>
+struct std::hash<bitset::view> {
+  std::size_t operator()(const bitset::view& bs_view) const noexcept;
+};
+
+template <>
+struct std::hash<bitset> {
+  std::size_t operator()(const bitset& bs) const noexcept;
+};
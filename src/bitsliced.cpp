@@ -0,0 +1,150 @@
+#include "bitsliced.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+
+std::size_t row_count(std::span<const bitset> planes) {
+  assert(!planes.empty());
+  assert(std::all_of(planes.begin(), planes.end(), [&](const bitset& plane) {
+    return plane.size() == planes[0].size();
+  }));
+  return planes[0].size();
+}
+
+} // namespace
+
+std::vector<bitset> bitsliced_encode(std::span<const uint64_t> values) {
+  uint64_t max_value = values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+  std::vector<bitset> res(std::max<std::size_t>(1, std::bit_width(max_value)), bitset(values.size(), false));
+  for (std::size_t row = 0; row < values.size(); ++row) {
+    for (uint64_t value = values[row]; value != 0; value &= value - 1) {
+      res[std::countr_zero(value)].set(row);
+    }
+  }
+  return res;
+}
+
+uint64_t bitsliced_value(std::span<const bitset> planes, std::size_t row) {
+  assert(planes.size() <= std::numeric_limits<uint64_t>::digits);
+  uint64_t res = 0;
+  for (std::size_t i = 0; i < planes.size(); ++i) {
+    res |= uint64_t(planes[i].test(row)) << i;
+  }
+  return res;
+}
+
+std::vector<bitset> bitsliced_add(std::span<const bitset> lhs, std::span<const bitset> rhs) {
+  std::size_t rows = row_count(lhs);
+  assert(row_count(rhs) == rows);
+  std::size_t width = std::max(lhs.size(), rhs.size());
+  std::vector<bitset> res(width + 1, bitset(rows, false));
+  for (std::size_t word = 0; word < lhs[0].word_count(); ++word) {
+    // Ripple-carry adder, 64 rows at a time
+    word_type carry = 0;
+    for (std::size_t i = 0; i < width; ++i) {
+      word_type a = i < lhs.size() ? lhs[i].load_word(word) : 0;
+      word_type b = i < rhs.size() ? rhs[i].load_word(word) : 0;
+      word_type half = a ^ b;
+      res[i].store_word(word, half ^ carry);
+      carry = (a & b) | (half & carry);
+    }
+    res[width].store_word(word, carry);
+  }
+  return res;
+}
+
+// O'Neil and Quass, 1997
+std::pair<word_type, word_type> bitsliced_compare_word(
+    std::span<const bitset> planes,
+    std::size_t word,
+    uint64_t value
+) {
+  if (static_cast<std::size_t>(std::bit_width(value)) > planes.size()) {
+    return {ALL_ONE, 0};
+  }
+  word_type less = 0;
+  word_type equal = ALL_ONE;
+  for (std::size_t i = planes.size(); i-- > 0;) {
+    word_type plane = planes[i].load_word(word);
+    if (((value >> i) & 1) != 0) {
+      less |= equal & ~plane;
+      equal &= plane;
+    } else {
+      equal &= ~plane;
+    }
+  }
+  return {less, equal};
+}
+
+bitset bitsliced_equal(std::span<const bitset> planes, uint64_t value) {
+  bitset res(row_count(planes), false);
+  for (std::size_t word = 0; word < res.word_count(); ++word) {
+    res.store_word(word, bitsliced_compare_word(planes, word, value).second);
+  }
+  return res;
+}
+
+bitset bitsliced_less(std::span<const bitset> planes, uint64_t value) {
+  bitset res(row_count(planes), false);
+  for (std::size_t word = 0; word < res.word_count(); ++word) {
+    res.store_word(word, bitsliced_compare_word(planes, word, value).first);
+  }
+  return res;
+}
+
+bitset bitsliced_between(std::span<const bitset> planes, uint64_t low, uint64_t high) {
+  bitset res(row_count(planes), false);
+  if (low > high) {
+    return res;
+  }
+  for (std::size_t word = 0; word < res.word_count(); ++word) {
+    auto [below_high, equal_high] = bitsliced_compare_word(planes, word, high);
+    word_type below_low = bitsliced_compare_word(planes, word, low).first;
+    res.store_word(word, (below_high | equal_high) & ~below_low);
+  }
+  return res;
+}
+
+bitset bitsliced_in(std::span<const bitset> planes, std::span<const uint64_t> values) {
+  bitset res(row_count(planes), false);
+  for (std::size_t word = 0; word < res.word_count(); ++word) {
+    word_type any_equal = 0;
+    for (uint64_t value : values) {
+      any_equal |= bitsliced_compare_word(planes, word, value).second;
+    }
+    res.store_word(word, any_equal);
+  }
+  return res;
+}
+
+std::vector<bitset> bitsliced_count(std::span<const bitset> planes) {
+  std::size_t rows = row_count(planes);
+  std::size_t width = std::bit_width(planes.size());
+  std::vector<bitset> res(width, bitset(rows, false));
+  std::vector<word_type> counter(width);
+  for (std::size_t word = 0; word < planes[0].word_count(); ++word) {
+    std::fill(counter.begin(), counter.end(), 0);
+    for (const bitset& plane : planes) {
+      // Vertical increment: propagate the carry only while it is non-zero
+      word_type carry = plane.load_word(word);
+      for (std::size_t i = 0; carry != 0; ++i) {
+        word_type next = counter[i] & carry;
+        counter[i] ^= carry;
+        carry = next;
+      }
+    }
+    for (std::size_t i = 0; i < width; ++i) {
+      res[i].store_word(word, counter[i]);
+    }
+  }
+  return res;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Arithmetic on unsigned numbers stored vertically: plane `i` holds bit `i` (least significant
+// first) of every row, all planes have the same size. Every operation processes 64 rows per
+// word, walking all planes of a word before moving on to the next one.
+//
+// Planes sequences are never empty: a column of zeroes is a single zero plane.
+
+std::vector<bitset> bitsliced_encode(std::span<const uint64_t> values);
+uint64_t bitsliced_value(std::span<const bitset> planes, std::size_t row);
+
+// Row-wise sum; has one plane more than the wider operand
+std::vector<bitset> bitsliced_add(std::span<const bitset> lhs, std::span<const bitset> rhs);
+
+// Masks of the rows `< value` and `== value` among the `word`-th words of the planes, for callers
+// that combine several comparisons word by word
+std::pair<bitset::word_type, bitset::word_type> bitsliced_compare_word(
+    std::span<const bitset> planes,
+    std::size_t word,
+    uint64_t value
+);
+
+bitset bitsliced_equal(std::span<const bitset> planes, uint64_t value);
+bitset bitsliced_less(std::span<const bitset> planes, uint64_t value);
+// Rows with `low <= value <= high`
+bitset bitsliced_between(std::span<const bitset> planes, uint64_t low, uint64_t high);
+// Rows whose value is one of `values`, in a single pass over the planes
+bitset bitsliced_in(std::span<const bitset> planes, std::span<const uint64_t> values);
+
+// Per row, the number of planes with the bit set, as `bit_width(planes.size())` planes
+std::vector<bitset> bitsliced_count(std::span<const bitset> planes);
@@ -0,0 +1,129 @@
+#include "counted-bitset.h"
+
+#include <algorithm>
+
+counted_bitset::counted_bitset()
+    : counted_bitset(0, false) {}
+
+counted_bitset::counted_bitset(std::size_t size, bool value)
+    : _bits(size, value)
+    , _count(0) {
+  init_counts();
+}
+
+counted_bitset::counted_bitset(const const_view& other)
+    : _bits(other)
+    , _count(0) {
+  init_counts();
+}
+
+std::size_t counted_bitset::size() const {
+  return _bits.size();
+}
+
+bool counted_bitset::empty() const {
+  return size() == 0;
+}
+
+counted_bitset& counted_bitset::set(std::size_t first, std::size_t last, bool value) {
+  _bits.set(first, last, value);
+  recount(first, last);
+  return *this;
+}
+
+counted_bitset& counted_bitset::reset(std::size_t first, std::size_t last) {
+  return set(first, last, false);
+}
+
+counted_bitset& counted_bitset::flip(std::size_t first, std::size_t last) {
+  _bits.flip(first, last);
+  recount(first, last);
+  return *this;
+}
+
+counted_bitset& counted_bitset::set() {
+  return set(0, size(), true);
+}
+
+counted_bitset& counted_bitset::reset() {
+  return set(0, size(), false);
+}
+
+counted_bitset& counted_bitset::flip() {
+  return flip(0, size());
+}
+
+template <class Function>
+counted_bitset& counted_bitset::apply_blocks(const const_view& other, Function binary_op) {
+  assert(size() == other.size());
+  // The block is recounted right after it's written, while it's still in cache
+  for (std::size_t block = 0; block < _block_counts.size(); ++block) {
+    std::size_t first = block * BLOCK_SIZE;
+    binary_op(_bits.subview(first, BLOCK_SIZE), other.subview(first, BLOCK_SIZE));
+    recount(first, first + 1);
+  }
+  return *this;
+}
+
+counted_bitset& counted_bitset::operator&=(const const_view& other) {
+  return apply_blocks(other, [](const view& lhs, const const_view& rhs) { lhs &= rhs; });
+}
+
+counted_bitset& counted_bitset::operator|=(const const_view& other) {
+  return apply_blocks(other, [](const view& lhs, const const_view& rhs) { lhs |= rhs; });
+}
+
+counted_bitset& counted_bitset::operator^=(const const_view& other) {
+  return apply_blocks(other, [](const view& lhs, const const_view& rhs) { lhs ^= rhs; });
+}
+
+std::size_t counted_bitset::count() const {
+  return _count;
+}
+
+bool counted_bitset::all() const {
+  return count() == size();
+}
+
+bool counted_bitset::any() const {
+  return count() != 0;
+}
+
+std::size_t counted_bitset::rank(std::size_t pos) const {
+  assert(pos <= size());
+  std::size_t block = pos / BLOCK_SIZE;
+  std::size_t res = 0;
+  for (std::size_t i = 0; i < block; ++i) {
+    res += _block_counts[i];
+  }
+  return res + _bits.subview(block * BLOCK_SIZE, pos - block * BLOCK_SIZE).count();
+}
+
+std::size_t counted_bitset::block_count(std::size_t block) const {
+  return _block_counts[block];
+}
+
+const bitset& counted_bitset::bits() const {
+  return _bits;
+}
+
+counted_bitset::operator const_view() const {
+  return _bits;
+}
+
+void counted_bitset::init_counts() {
+  _block_counts.assign((size() + BLOCK_SIZE - 1) / BLOCK_SIZE, 0);
+  _count = 0;
+  recount(0, size());
+}
+
+void counted_bitset::recount(std::size_t first, std::size_t last) {
+  if (first >= last) {
+    return;
+  }
+  for (std::size_t block = first / BLOCK_SIZE; block <= (last - 1) / BLOCK_SIZE; ++block) {
+    std::size_t block_count = _bits.subview(block * BLOCK_SIZE, BLOCK_SIZE).count();
+    _count = _count - _block_counts[block] + block_count;
+    _block_counts[block] = static_cast<uint16_t>(block_count);
+  }
+}
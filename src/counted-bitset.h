@@ -0,0 +1,156 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bitset that keeps its popcount up to date on every mutation, together with the counts
+// of every block of `BLOCK_SIZE` bits. `count`, `all` and `any` are O(1), `rank` sums block counts.
+class counted_bitset {
+public:
+  using value_type = bool;
+  using word_type = bitset::word_type;
+
+  using view = bitset::view;
+  using const_view = bitset::const_view;
+
+  // One cache line of bits
+  static constexpr std::size_t BLOCK_SIZE = 512;
+
+  class reference {
+  public:
+    reference(const reference& other) = default;
+
+    reference& operator=(bool value) {
+      _owner->assign(_pos, value);
+      return *this;
+    }
+
+    reference& operator=(const reference& other) {
+      return *this = static_cast<bool>(other);
+    }
+
+    operator bool() const {
+      return _owner->test(_pos);
+    }
+
+    reference& flip() {
+      _owner->flip(_pos);
+      return *this;
+    }
+
+  private:
+    counted_bitset* _owner;
+    std::size_t _pos;
+
+    reference(counted_bitset* owner, std::size_t pos)
+        : _owner(owner)
+        , _pos(pos) {}
+
+    friend class counted_bitset;
+  };
+
+  counted_bitset();
+  counted_bitset(std::size_t size, bool value);
+  explicit counted_bitset(const const_view& other);
+
+  std::size_t size() const;
+  bool empty() const;
+
+  bool test(std::size_t pos) const;
+  bool operator[](std::size_t pos) const;
+  reference operator[](std::size_t pos);
+
+  counted_bitset& set(std::size_t pos);
+  counted_bitset& reset(std::size_t pos);
+  counted_bitset& flip(std::size_t pos);
+  counted_bitset& assign(std::size_t pos, bool value);
+
+  counted_bitset& set(std::size_t first, std::size_t last, bool value);
+  counted_bitset& reset(std::size_t first, std::size_t last);
+  counted_bitset& flip(std::size_t first, std::size_t last);
+
+  counted_bitset& set();
+  counted_bitset& reset();
+  counted_bitset& flip();
+
+  counted_bitset& operator&=(const const_view& other);
+  counted_bitset& operator|=(const const_view& other);
+  counted_bitset& operator^=(const const_view& other);
+
+  std::size_t count() const;
+  bool all() const;
+  bool any() const;
+
+  // Number of ones in [0, pos)
+  std::size_t rank(std::size_t pos) const;
+
+  std::size_t block_count(std::size_t block) const;
+
+  const bitset& bits() const;
+  operator const_view() const;
+
+private:
+  bitset _bits;
+  std::vector<uint16_t> _block_counts;
+  std::size_t _count;
+
+  void init_counts();
+  void recount(std::size_t first, std::size_t last);
+
+  void add_bit(std::size_t pos, bool value);
+
+  template <class Function>
+  counted_bitset& apply_blocks(const const_view& other, Function binary_op);
+};
+
+inline bool counted_bitset::test(std::size_t pos) const {
+  return _bits.test(pos);
+}
+
+inline bool counted_bitset::operator[](std::size_t pos) const {
+  return test(pos);
+}
+
+inline counted_bitset::reference counted_bitset::operator[](std::size_t pos) {
+  return {this, pos};
+}
+
+inline void counted_bitset::add_bit(std::size_t pos, bool value) {
+  if (value) {
+    ++_block_counts[pos / BLOCK_SIZE];
+    ++_count;
+  } else {
+    --_block_counts[pos / BLOCK_SIZE];
+    --_count;
+  }
+}
+
+inline counted_bitset& counted_bitset::set(std::size_t pos) {
+  if (!_bits.test(pos)) {
+    _bits.set(pos);
+    add_bit(pos, true);
+  }
+  return *this;
+}
+
+inline counted_bitset& counted_bitset::reset(std::size_t pos) {
+  if (_bits.test(pos)) {
+    _bits.reset(pos);
+    add_bit(pos, false);
+  }
+  return *this;
+}
+
+inline counted_bitset& counted_bitset::flip(std::size_t pos) {
+  _bits.flip(pos);
+  add_bit(pos, _bits.test(pos));
+  return *this;
+}
+
+inline counted_bitset& counted_bitset::assign(std::size_t pos, bool value) {
+  return value ? set(pos) : reset(pos);
+}
@@ -0,0 +1,126 @@
+#include "sharded-bitset.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t WORD_BITS = std::numeric_limits<sharded_bitset::word_type>::digits;
+
+} // namespace
+
+sharded_bitset::sharded_bitset(std::size_t size, bool value, std::size_t shard_size)
+    : _size(size)
+    , _shard_size((std::max<std::size_t>(shard_size, 1) + CACHE_LINE_BITS - 1) / CACHE_LINE_BITS * CACHE_LINE_BITS)
+    , _shard_count((size + _shard_size - 1) / _shard_size)
+    , _shards(std::make_unique<shard[]>(_shard_count)) {
+  std::size_t words = (size + CACHE_LINE_BITS - 1) / CACHE_LINE_BITS * (CACHE_LINE_BITS / WORD_BITS);
+  void* data = ::operator new(words * sizeof(word_type), std::align_val_t(CACHE_LINE_BYTES));
+  _storage.reset(static_cast<word_type*>(data));
+  std::fill_n(_storage.get(), words, value ? ~word_type(0) : 0);
+  for (std::size_t i = 0; i < _shard_count; ++i) {
+    std::size_t length = std::min(_shard_size, size - i * _shard_size);
+    _shards[i].bits = bitset::view(_storage.get(), i * _shard_size, length);
+    _shards[i].count.store(value ? length : 0, std::memory_order_relaxed);
+  }
+}
+
+void sharded_bitset::storage_deleter::operator()(word_type* data) const {
+  ::operator delete(data, std::align_val_t(CACHE_LINE_BYTES));
+}
+
+std::size_t sharded_bitset::size() const {
+  return _size;
+}
+
+bool sharded_bitset::empty() const {
+  return size() == 0;
+}
+
+std::size_t sharded_bitset::shard_size() const {
+  return _shard_size;
+}
+
+std::size_t sharded_bitset::shard_count() const {
+  return _shard_count;
+}
+
+std::size_t sharded_bitset::shard_of(std::size_t pos) const {
+  return pos / _shard_size;
+}
+
+template <class Function>
+void sharded_bitset::update_bit(std::size_t pos, Function function) {
+  assert(pos < size());
+  shard& sh = _shards[shard_of(pos)];
+  std::size_t index = pos % _shard_size;
+
+  std::lock_guard lock(sh.mutex);
+  bool old_value = sh.bits[index];
+  function(sh.bits, index);
+  bool new_value = sh.bits[index];
+  if (old_value != new_value) {
+    if (new_value) {
+      sh.count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      sh.count.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool sharded_bitset::test(std::size_t pos) const {
+  assert(pos < size());
+  const shard& sh = _shards[shard_of(pos)];
+  std::lock_guard lock(sh.mutex);
+  return sh.bits[pos % _shard_size];
+}
+
+void sharded_bitset::set(std::size_t pos) {
+  update_bit(pos, [](bitset::view bits, std::size_t index) { bits[index] = true; });
+}
+
+void sharded_bitset::reset(std::size_t pos) {
+  update_bit(pos, [](bitset::view bits, std::size_t index) { bits[index] = false; });
+}
+
+void sharded_bitset::flip(std::size_t pos) {
+  update_bit(pos, [](bitset::view bits, std::size_t index) { bits[index].flip(); });
+}
+
+std::size_t sharded_bitset::count() const {
+  std::size_t res = 0;
+  for (std::size_t i = 0; i < _shard_count; ++i) {
+    res += _shards[i].count.load(std::memory_order_relaxed);
+  }
+  return res;
+}
+
+bool sharded_bitset::any() const {
+  for (std::size_t i = 0; i < _shard_count; ++i) {
+    if (_shards[i].count.load(std::memory_order_relaxed) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool sharded_bitset::all() const {
+  return count() == size();
+}
+
+bitset sharded_bitset::snapshot() const {
+  std::vector<std::unique_lock<std::mutex>> locks;
+  locks.reserve(_shard_count);
+  for (std::size_t i = 0; i < _shard_count; ++i) {
+    locks.emplace_back(_shards[i].mutex);
+  }
+
+  bitset res(size(), false);
+  for (std::size_t i = 0; i < _shard_count; ++i) {
+    res.subview(i * _shard_size, _shards[i].bits.size()) |= _shards[i].bits;
+  }
+  return res;
+}
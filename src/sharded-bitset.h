@@ -0,0 +1,84 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+// Bitset split into independently locked shards, so that threads working on different
+// shards never contend. Every shard caches its popcount, which lets `count`/`any`/`all`
+// run concurrently with writers without taking any lock.
+class sharded_bitset {
+public:
+  using word_type = bitset::word_type;
+
+  // One page of bits
+  static constexpr std::size_t DEFAULT_SHARD_SIZE = 4096 * 8;
+
+  sharded_bitset(std::size_t size, bool value, std::size_t shard_size = DEFAULT_SHARD_SIZE);
+
+  std::size_t size() const;
+  bool empty() const;
+
+  std::size_t shard_size() const;
+  std::size_t shard_count() const;
+  std::size_t shard_of(std::size_t pos) const;
+
+  bool test(std::size_t pos) const;
+  void set(std::size_t pos);
+  void reset(std::size_t pos);
+  void flip(std::size_t pos);
+
+  // Calls `function(bitset::view)` on the shard under its lock and refreshes the cached count
+  template <class Function>
+  void modify(std::size_t shard_index, Function function) {
+    shard& sh = _shards[shard_index];
+    std::lock_guard lock(sh.mutex);
+    function(bitset::view(sh.bits));
+    sh.count.store(sh.bits.count(), std::memory_order_relaxed);
+  }
+
+  // Calls `function(bitset::const_view)` on the shard under its lock and returns the result
+  template <class Function>
+  auto read(std::size_t shard_index, Function function) const {
+    const shard& sh = _shards[shard_index];
+    std::lock_guard lock(sh.mutex);
+    return function(bitset::const_view(sh.bits));
+  }
+
+  // Aggregates of the cached per-shard counts: lock-free, each shard is observed in some consistent state
+  std::size_t count() const;
+  bool any() const;
+  bool all() const;
+
+  // Consistent copy of the whole set: all shard locks are held while copying
+  bitset snapshot() const;
+
+private:
+  static constexpr std::size_t CACHE_LINE_BYTES = 64;
+  static constexpr std::size_t CACHE_LINE_BITS = CACHE_LINE_BYTES * 8;
+
+  // Padded to a cache line, so that locks and counts of neighbouring shards don't share one
+  struct alignas(CACHE_LINE_BYTES) shard {
+    mutable std::mutex mutex;
+    std::atomic<std::size_t> count{0};
+    bitset::view bits;
+  };
+
+  struct storage_deleter {
+    void operator()(word_type* data) const;
+  };
+
+  std::size_t _size;
+  std::size_t _shard_size;
+  std::size_t _shard_count;
+  // Words of all shards in one cache-line aligned block; shard sizes are whole cache lines,
+  // so every shard starts on a line of its own
+  std::unique_ptr<word_type[], storage_deleter> _storage;
+  std::unique_ptr<shard[]> _shards;
+
+  template <class Function>
+  void update_bit(std::size_t pos, Function function);
+};
@@ -0,0 +1,212 @@
+#include "summary-bitset.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+namespace {
+
+using word_type = bitset::word_type;
+
+constexpr std::size_t INT_SIZE = std::numeric_limits<word_type>::digits;
+constexpr word_type ALL_ONE = std::numeric_limits<word_type>::max();
+
+} // namespace
+
+summary_bitset::summary_bitset()
+    : summary_bitset(0, false) {}
+
+summary_bitset::summary_bitset(std::size_t size, bool value)
+    : _levels(1, bitset(size, value)) {
+  build_levels();
+}
+
+summary_bitset::summary_bitset(const const_view& other)
+    : _levels(1, bitset(other)) {
+  build_levels();
+}
+
+std::size_t summary_bitset::size() const {
+  return _levels[0].size();
+}
+
+bool summary_bitset::empty() const {
+  return size() == 0;
+}
+
+bool summary_bitset::test(std::size_t pos) const {
+  return _levels[0].test(pos);
+}
+
+summary_bitset& summary_bitset::set(std::size_t pos) {
+  _levels[0].set(pos);
+  update_word(0, pos / INT_SIZE);
+  return *this;
+}
+
+summary_bitset& summary_bitset::reset(std::size_t pos) {
+  _levels[0].reset(pos);
+  update_word(0, pos / INT_SIZE);
+  return *this;
+}
+
+summary_bitset& summary_bitset::flip(std::size_t pos) {
+  _levels[0].flip(pos);
+  update_word(0, pos / INT_SIZE);
+  return *this;
+}
+
+summary_bitset& summary_bitset::set(std::size_t first, std::size_t last, bool value) {
+  _levels[0].set(first, last, value);
+  if (first < last) {
+    refresh(first / INT_SIZE, (last - 1) / INT_SIZE);
+  }
+  return *this;
+}
+
+summary_bitset& summary_bitset::reset(std::size_t first, std::size_t last) {
+  return set(first, last, false);
+}
+
+summary_bitset& summary_bitset::operator&=(const summary_bitset& other) {
+  assert(size() == other.size());
+  if (_levels.size() == 1) {
+    _levels[0] &= other._levels[0];
+    return *this;
+  }
+  // Only words that are non-zero here can change
+  for (std::size_t word = find_in_level(1, 0); word != npos; word = find_in_level(1, word + 1)) {
+    word_type res = other._levels[1].test(word) ? _levels[0].load_word(word) & other._levels[0].load_word(word) : 0;
+    _levels[0].store_word(word, res);
+    update_word(0, word);
+  }
+  return *this;
+}
+
+summary_bitset& summary_bitset::operator|=(const summary_bitset& other) {
+  assert(size() == other.size());
+  if (_levels.size() == 1) {
+    _levels[0] |= other._levels[0];
+    return *this;
+  }
+  for (std::size_t word = other.find_in_level(1, 0); word != npos; word = other.find_in_level(1, word + 1)) {
+    _levels[0].store_word(word, _levels[0].load_word(word) | other._levels[0].load_word(word));
+    update_word(0, word);
+  }
+  return *this;
+}
+
+summary_bitset& summary_bitset::operator^=(const summary_bitset& other) {
+  assert(size() == other.size());
+  if (_levels.size() == 1) {
+    _levels[0] ^= other._levels[0];
+    return *this;
+  }
+  for (std::size_t word = other.find_in_level(1, 0); word != npos; word = other.find_in_level(1, word + 1)) {
+    _levels[0].store_word(word, _levels[0].load_word(word) ^ other._levels[0].load_word(word));
+    update_word(0, word);
+  }
+  return *this;
+}
+
+bool summary_bitset::any() const {
+  return _levels.back().any();
+}
+
+std::size_t summary_bitset::count() const {
+  if (_levels.size() == 1) {
+    return _levels[0].count();
+  }
+  std::size_t res = 0;
+  for (std::size_t word = find_in_level(1, 0); word != npos; word = find_in_level(1, word + 1)) {
+    res += std::popcount(_levels[0].load_word(word));
+  }
+  return res;
+}
+
+std::size_t summary_bitset::find_first() const {
+  return find_next(0);
+}
+
+std::size_t summary_bitset::find_next(std::size_t pos) const {
+  return find_in_level(0, pos);
+}
+
+std::size_t summary_bitset::level_count() const {
+  return _levels.size();
+}
+
+const bitset& summary_bitset::bits() const {
+  return _levels[0];
+}
+
+summary_bitset::operator const_view() const {
+  return _levels[0];
+}
+
+void summary_bitset::build_levels() {
+  while (_levels.back().size() > INT_SIZE) {
+    std::size_t words = (_levels.back().size() + INT_SIZE - 1) / INT_SIZE;
+    _levels.emplace_back(words, false);
+    const bitset& lower = _levels[_levels.size() - 2];
+    bitset& upper = _levels.back();
+    for (std::size_t word = 0; word < words; ++word) {
+      if (lower.load_word(word) != 0) {
+        upper.set(word);
+      }
+    }
+  }
+}
+
+void summary_bitset::update_word(std::size_t level, std::size_t word) {
+  for (; level + 1 < _levels.size(); ++level) {
+    bool non_zero = _levels[level].load_word(word) != 0;
+    bitset& upper = _levels[level + 1];
+    if (upper.test(word) == non_zero) {
+      // Levels above already agree
+      return;
+    }
+    if (non_zero) {
+      upper.set(word);
+    } else {
+      upper.reset(word);
+    }
+    word /= INT_SIZE;
+  }
+}
+
+void summary_bitset::refresh(std::size_t first_word, std::size_t last_word) {
+  for (std::size_t level = 0; level + 1 < _levels.size(); ++level) {
+    bitset& upper = _levels[level + 1];
+    for (std::size_t word = first_word; word <= last_word; ++word) {
+      if (_levels[level].load_word(word) != 0) {
+        upper.set(word);
+      } else {
+        upper.reset(word);
+      }
+    }
+    first_word /= INT_SIZE;
+    last_word /= INT_SIZE;
+  }
+}
+
+std::size_t summary_bitset::find_in_level(std::size_t level, std::size_t pos) const {
+  const bitset& bits = _levels[level];
+  if (pos >= bits.size()) {
+    return npos;
+  }
+  if (level + 1 == _levels.size()) {
+    return bits.find_next(pos);
+  }
+  std::size_t word = pos / INT_SIZE;
+  word_type current = bits.load_word(word) & (ALL_ONE >> (pos % INT_SIZE));
+  if (current != 0) {
+    return word * INT_SIZE + std::countl_zero(current);
+  }
+  std::size_t next = find_in_level(level + 1, word + 1);
+  if (next == npos) {
+    return npos;
+  }
+  return next * INT_SIZE + std::countl_zero(bits.load_word(next));
+}
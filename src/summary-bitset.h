@@ -0,0 +1,67 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <cstddef>
+#include <vector>
+
+// Bitset with a hierarchy of summaries on top of it: a bit of level `k + 1` is set iff the
+// corresponding word of level `k` is non-zero, and levels are added until one fits in a word.
+// Scans (`any`, `count`, `find_next`, binary operations) visit only non-zero words, which
+// makes them proportional to the number of set bits rather than to the size of very sparse sets.
+class summary_bitset {
+public:
+  using word_type = bitset::word_type;
+
+  using const_view = bitset::const_view;
+
+  static constexpr std::size_t npos = bitset::npos;
+
+  summary_bitset();
+  summary_bitset(std::size_t size, bool value);
+  explicit summary_bitset(const const_view& other);
+
+  std::size_t size() const;
+  bool empty() const;
+
+  bool test(std::size_t pos) const;
+  summary_bitset& set(std::size_t pos);
+  summary_bitset& reset(std::size_t pos);
+  summary_bitset& flip(std::size_t pos);
+
+  summary_bitset& set(std::size_t first, std::size_t last, bool value);
+  summary_bitset& reset(std::size_t first, std::size_t last);
+
+  summary_bitset& operator&=(const summary_bitset& other);
+  summary_bitset& operator|=(const summary_bitset& other);
+  summary_bitset& operator^=(const summary_bitset& other);
+
+  bool any() const;
+  std::size_t count() const;
+
+  std::size_t find_first() const;
+  std::size_t find_next(std::size_t pos) const;
+
+  // Calls `function(pos)` for every set bit in increasing order
+  template <class Function>
+  void for_each(Function function) const {
+    for (std::size_t pos = find_first(); pos != npos; pos = find_next(pos + 1)) {
+      function(pos);
+    }
+  }
+
+  std::size_t level_count() const;
+
+  const bitset& bits() const;
+  operator const_view() const;
+
+private:
+  // `_levels[0]` is the data itself
+  std::vector<bitset> _levels;
+
+  void build_levels();
+  void update_word(std::size_t level, std::size_t word);
+  void refresh(std::size_t first_word, std::size_t last_word);
+
+  std::size_t find_in_level(std::size_t level, std::size_t pos) const;
+};
@@ -57,6 +57,40 @@ TEST_CASE("bitset constructor from size and vaue") {
   }
 }
 
+TEST_CASE("bitset large constructor from size and value") {
+  bool bit = GENERATE(false, true);
+  CAPTURE(bit);
+  // Large enough for the storage to be mapped from the OS
+  std::size_t size = (std::size_t(1) << 24) + 5;
+  bitset bs(size, bit);
+
+  CHECK(bs.size() == size);
+  CHECK(bs.count() == (bit ? size : 0));
+  bs.flip(size - 1);
+  CHECK(bs.find_first() == (bit ? 0 : size - 1));
+}
+
+TEST_CASE("bitset::filled") {
+  CHECK(bitset::filled(0, 0xf0f0f0f0f0f0f0f0).empty());
+  CHECK_THAT(bitset::filled(10, 0xa000000000000000), bitset_equals_string("1010000000"));
+
+  std::string expected;
+  for (std::size_t i = 0; i < 3; ++i) {
+    expected += "1100101000000000000000000000000000000000000000000000000000000001";
+  }
+  expected.resize(150);
+  CHECK_THAT(bitset::filled(150, 0xca00000000000001), bitset_equals_string(expected));
+  CHECK(bitset::filled(1000, 0).count() == 0);
+}
+
+TEST_CASE("bitset::uninitialized") {
+  bitset bs = bitset::uninitialized(100);
+  CHECK(bs.size() == 100);
+  bs.set(0, 100, false);
+  bs.set(99);
+  CHECK(bs.count() == 1);
+}
+
 TEST_CASE("bitset constructor from string") {
   SECTION("empty") {
     const bitset bs("");
@@ -0,0 +1,83 @@
+#include "bitsliced.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<uint64_t> random_values(std::size_t rows, uint64_t max_value, std::mt19937& rng) {
+  std::uniform_int_distribution<uint64_t> value(0, max_value);
+  std::vector<uint64_t> res(rows);
+  for (uint64_t& v : res) {
+    v = value(rng);
+  }
+  return res;
+}
+
+} // namespace
+
+TEST_CASE("bitsliced encode") {
+  CHECK(bitsliced_encode(std::vector<uint64_t>{0, 0}).size() == 1);
+  CHECK(bitsliced_encode(std::vector<uint64_t>{}).size() == 1);
+
+  std::vector<uint64_t> values = {5, 0, 13, 1};
+  std::vector<bitset> planes = bitsliced_encode(values);
+  REQUIRE(planes.size() == 4);
+  CHECK(planes[0] == bitset("1011"));
+  CHECK(planes[3] == bitset("0010"));
+  for (std::size_t row = 0; row < values.size(); ++row) {
+    CHECK(bitsliced_value(planes, row) == values[row]);
+  }
+}
+
+TEST_CASE("bitsliced arithmetic") {
+  std::size_t rows = GENERATE(1, 64, 100, 1000);
+  std::mt19937 rng(static_cast<unsigned>(rows));
+  std::vector<uint64_t> lhs = random_values(rows, 1000, rng);
+  std::vector<uint64_t> rhs = random_values(rows, 30, rng);
+  std::vector<bitset> lhs_planes = bitsliced_encode(lhs);
+  std::vector<bitset> rhs_planes = bitsliced_encode(rhs);
+
+  SECTION("add") {
+    std::vector<bitset> sum = bitsliced_add(lhs_planes, rhs_planes);
+    CHECK(sum.size() == lhs_planes.size() + 1);
+    for (std::size_t row = 0; row < rows; ++row) {
+      REQUIRE(bitsliced_value(sum, row) == lhs[row] + rhs[row]);
+    }
+    CHECK(bitsliced_add(rhs_planes, lhs_planes) == sum);
+  }
+
+  SECTION("compare") {
+    for (uint64_t value : {uint64_t(0), uint64_t(1), uint64_t(17), uint64_t(500), uint64_t(1023), uint64_t(5000)}) {
+      bitset equal = bitsliced_equal(lhs_planes, value);
+      bitset less = bitsliced_less(lhs_planes, value);
+      bitset between = bitsliced_between(lhs_planes, value, value + 100);
+      for (std::size_t row = 0; row < rows; ++row) {
+        REQUIRE(equal[row] == (lhs[row] == value));
+        REQUIRE(less[row] == (lhs[row] < value));
+        REQUIRE(between[row] == (value <= lhs[row] && lhs[row] <= value + 100));
+      }
+    }
+    CHECK(bitsliced_between(lhs_planes, 10, 5).count() == 0);
+
+    std::vector<uint64_t> values = {lhs[0], 17, lhs[rows / 2], 5000, lhs[0]};
+    bitset in = bitsliced_in(lhs_planes, values);
+    for (std::size_t row = 0; row < rows; ++row) {
+      REQUIRE(in[row] == (std::find(values.begin(), values.end(), lhs[row]) != values.end()));
+    }
+    CHECK(bitsliced_in(lhs_planes, {}).count() == 0);
+  }
+
+  SECTION("count") {
+    std::vector<bitset> counts = bitsliced_count(lhs_planes);
+    CHECK(counts.size() == static_cast<std::size_t>(std::bit_width(lhs_planes.size())));
+    for (std::size_t row = 0; row < rows; ++row) {
+      REQUIRE(bitsliced_value(counts, row) == static_cast<uint64_t>(std::popcount(lhs[row])));
+    }
+  }
+}
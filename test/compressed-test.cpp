@@ -0,0 +1,106 @@
+#include "bitset-compressed.h"
+#include "bitset.h"
+#include "test-helpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <string>
+
+namespace {
+
+// Long runs of equal bits interleaved with noisy stretches
+bitset make_timeline(std::size_t size, std::mt19937& rng) {
+  bitset bs(size, false);
+  std::uniform_int_distribution<std::size_t> length(1, 300);
+  std::bernoulli_distribution coin(0.5);
+  std::size_t pos = 0;
+  while (pos < size) {
+    std::size_t end = std::min(size, pos + length(rng));
+    int kind = static_cast<int>(rng() % 3);
+    for (std::size_t i = pos; i < end; ++i) {
+      bs[i] = (kind == 0) || (kind == 2 && coin(rng));
+    }
+    pos = end;
+  }
+  return bs;
+}
+
+} // namespace
+
+TEST_CASE("rle encoding") {
+  SECTION("runs") {
+    CHECK(encode_rle(bitset("")).runs().empty());
+    CHECK(encode_rle(bitset("0011101")).runs() == std::vector<std::size_t>{2, 3, 1, 1});
+    CHECK(encode_rle(bitset("1100")).runs() == std::vector<std::size_t>{0, 2, 2});
+    CHECK(encode_rle(bitset(200, true)).runs() == std::vector<std::size_t>{0, 200});
+  }
+
+  SECTION("round trip and operations") {
+    std::size_t size = GENERATE(1, 64, 65, 1000, 5000);
+    std::size_t offset = GENERATE(0, 7);
+    CAPTURE(size, offset);
+
+    std::mt19937 rng(size);
+    bitset lhs = make_timeline(size + offset, rng);
+    bitset rhs = make_timeline(size, rng);
+    bitset::const_view lhs_view = std::as_const(lhs).subview(offset);
+
+    rle_bitset lhs_rle = encode_rle(lhs_view);
+    rle_bitset rhs_rle = encode_rle(rhs);
+    CHECK(lhs_rle.size() == size);
+    CHECK(lhs_rle.count() == lhs_view.count());
+    CHECK(lhs_rle.decode() == lhs_view);
+
+    bitset out(size + 3, true);
+    lhs_rle.decode(out.subview(3));
+    CHECK(out.subview(3) == lhs_view);
+    CHECK(out.subview(0, 3).all());
+
+    CHECK((lhs_rle & rhs_rle) == encode_rle(lhs_view & rhs));
+    CHECK((lhs_rle | rhs_rle) == encode_rle(lhs_view | rhs));
+    CHECK((lhs_rle ^ rhs_rle) == encode_rle(lhs_view ^ rhs));
+    CHECK((lhs_rle ^ rhs_rle).count() == (lhs_view ^ rhs).count());
+  }
+}
+
+TEST_CASE("ewah encoding") {
+  SECTION("clean words") {
+    ewah_bitset zeros = encode_ewah(bitset(64 * 10, false));
+    CHECK(zeros.words().size() == 1);
+    CHECK(zeros.count() == 0);
+
+    ewah_bitset ones = encode_ewah(bitset(64 * 10 + 5, true));
+    CHECK(ones.words().size() == 2);
+    CHECK(ones.count() == 64 * 10 + 5);
+    CHECK(ones.decode() == bitset(64 * 10 + 5, true));
+  }
+
+  SECTION("round trip and operations") {
+    std::size_t size = GENERATE(1, 64, 65, 1000, 5000, 20000);
+    std::size_t offset = GENERATE(0, 7);
+    CAPTURE(size, offset);
+
+    std::mt19937 rng(size);
+    bitset lhs = make_timeline(size + offset, rng);
+    bitset rhs = make_timeline(size, rng);
+    bitset::const_view lhs_view = std::as_const(lhs).subview(offset);
+
+    ewah_bitset lhs_ewah = encode_ewah(lhs_view);
+    ewah_bitset rhs_ewah = encode_ewah(rhs);
+    CHECK(lhs_ewah.size() == size);
+    CHECK(lhs_ewah.count() == lhs_view.count());
+    CHECK(lhs_ewah.decode() == lhs_view);
+
+    bitset out(size + 3, true);
+    lhs_ewah.decode(out.subview(3));
+    CHECK(out.subview(3) == lhs_view);
+    CHECK(out.subview(0, 3).all());
+
+    CHECK((lhs_ewah & rhs_ewah) == encode_ewah(lhs_view & rhs));
+    CHECK((lhs_ewah | rhs_ewah) == encode_ewah(lhs_view | rhs));
+    CHECK((lhs_ewah ^ rhs_ewah) == encode_ewah(lhs_view ^ rhs));
+    CHECK((lhs_ewah & rhs_ewah).decode() == (lhs_view & rhs));
+  }
+}
@@ -0,0 +1,106 @@
+#include "counted-bitset.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+
+namespace {
+
+void check_counts(const counted_bitset& bs) {
+  REQUIRE(bs.count() == bs.bits().count());
+  REQUIRE(bs.all() == bs.bits().all());
+  REQUIRE(bs.any() == bs.bits().any());
+  for (std::size_t block = 0; block * counted_bitset::BLOCK_SIZE < bs.size(); ++block) {
+    CAPTURE(block);
+    bitset::const_view bits = bs.bits().subview(block * counted_bitset::BLOCK_SIZE, counted_bitset::BLOCK_SIZE);
+    REQUIRE(bs.block_count(block) == bits.count());
+  }
+}
+
+} // namespace
+
+TEST_CASE("counted_bitset keeps counts up to date") {
+  std::size_t size = GENERATE(0, 1, 511, 512, 2000);
+  CAPTURE(size);
+
+  counted_bitset bs(size, false);
+  check_counts(bs);
+  if (size == 0) {
+    return;
+  }
+
+  std::mt19937 rng(size);
+  std::uniform_int_distribution<std::size_t> pos(0, size - 1);
+
+  for (int i = 0; i < 200; ++i) {
+    std::size_t a = pos(rng);
+    std::size_t b = pos(rng);
+    switch (rng() % 7) {
+    case 0:
+      bs.set(a);
+      break;
+    case 1:
+      bs.reset(a);
+      break;
+    case 2:
+      bs[a] = !bs[a];
+      break;
+    case 3:
+      bs[a].flip();
+      break;
+    case 4:
+      bs.set(std::min(a, b), std::max(a, b), rng() % 2 == 0);
+      break;
+    case 5:
+      bs.flip(std::min(a, b), std::max(a, b));
+      break;
+    default:
+      bs[a] = bs[b];
+      break;
+    }
+    check_counts(bs);
+  }
+
+  bitset other(size, false);
+  for (std::size_t i = 0; i < size; i += 3) {
+    other[i] = true;
+  }
+  bitset expected(bs.bits());
+
+  bs &= other;
+  expected &= other;
+  CHECK(bs.bits() == expected);
+  check_counts(bs);
+
+  bs |= other;
+  expected |= other;
+  CHECK(bs.bits() == expected);
+  check_counts(bs);
+
+  bs ^= other.flip();
+  expected ^= other;
+  CHECK(bs.bits() == expected);
+  check_counts(bs);
+
+  bs.flip();
+  check_counts(bs);
+  bs.set();
+  check_counts(bs);
+  CHECK(bs.all());
+  bs.reset();
+  check_counts(bs);
+  CHECK_FALSE(bs.any());
+}
+
+TEST_CASE("counted_bitset rank") {
+  bitset bits(1500, false);
+  for (std::size_t i = 0; i < bits.size(); i += 7) {
+    bits[i] = true;
+  }
+  const counted_bitset bs(bits);
+
+  std::size_t pos = GENERATE(0, 1, 511, 512, 513, 1499, 1500);
+  CAPTURE(pos);
+  CHECK(bs.rank(pos) == bits.subview(0, pos).count());
+}
@@ -0,0 +1,77 @@
+#include "bitset-delta.h"
+
+#include "test-helpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <stdexcept>
+
+TEST_CASE("diff and apply_delta") {
+  std::size_t size = GENERATE(0, 1, 64, 100, 5000);
+  CAPTURE(size);
+
+  std::mt19937 rng(size);
+  bitset from = random_bitset(size, rng);
+  bitset to(from);
+  for (std::size_t i = 0; i < size; i += 97) {
+    to.flip(i);
+  }
+
+  bitset_delta delta = diff(from, to);
+  CHECK(delta.patch_mode() == bitset_delta::mode::exclusive_or);
+  CHECK(delta.words().size() <= (size + 63) / 64);
+  CHECK(delta.empty() == (size == 0));
+
+  bitset patched(from);
+  apply_delta(patched, delta);
+  CHECK(patched == to);
+
+  bitset_delta restored = bitset_delta::deserialize(delta.serialize());
+  CHECK(restored == delta);
+
+  CHECK(diff(to, to).empty());
+}
+
+TEST_CASE("tracked_bitset export and apply") {
+  tracked_bitset leader(5000, false);
+  tracked_bitset follower(5000, false);
+  CHECK(leader.dirty_blocks() == 0);
+
+  leader.set(3);
+  leader.flip(600);
+  leader.set(4000, 4100, true);
+  CHECK(leader.dirty_blocks() == 4);
+
+  bitset_delta delta = leader.export_delta();
+  CHECK(leader.dirty_blocks() == 0);
+  CHECK(delta.patch_mode() == bitset_delta::mode::replace);
+  CHECK(delta.words().size() == 4 * tracked_bitset::BLOCK_SIZE / 64);
+
+  follower.apply_delta(bitset_delta::deserialize(delta.serialize()));
+  CHECK(follower.bits() == leader.bits());
+
+  bitset mask(5000, true);
+  mask.reset(0, 64);
+  leader &= mask;
+  CHECK(leader.dirty_blocks() == 1);
+  leader |= bitset(5000, false);
+  CHECK(leader.dirty_blocks() == 1);
+
+  follower.apply_delta(leader.export_delta());
+  CHECK(follower.bits() == leader.bits());
+  CHECK_FALSE(follower.test(3));
+  CHECK(follower.test(600));
+}
+
+TEST_CASE("bitset_delta rejects malformed input") {
+  bitset_delta delta = diff(bitset(200, false), bitset(200, true));
+  std::vector<std::byte> bytes = delta.serialize();
+
+  std::vector<std::byte> truncated(bytes.begin(), bytes.end() - 1);
+  CHECK_THROWS_AS(bitset_delta::deserialize(truncated), std::invalid_argument);
+
+  bytes.push_back(std::byte(0));
+  CHECK_THROWS_AS(bitset_delta::deserialize(bytes), std::invalid_argument);
+}
@@ -0,0 +1,80 @@
+#include "bitset-gather.h"
+#include "bitset.h"
+#include "test-helpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <string>
+
+namespace {
+
+std::string random_string(std::size_t size, std::mt19937& rng) {
+  std::bernoulli_distribution dist(0.5);
+  std::string str;
+  for (std::size_t i = 0; i < size; ++i) {
+    str.push_back(dist(rng) ? '1' : '0');
+  }
+  return str;
+}
+
+} // namespace
+
+TEST_CASE("extract") {
+  SECTION("simple") {
+    CHECK_THAT(extract(bitset("10110"), bitset("11001")), bitset_equals_string("100"));
+    CHECK_THAT(extract(bitset("10110"), bitset("00000")), bitset_equals_string(""));
+    CHECK_THAT(extract(bitset(""), bitset("")), bitset_equals_string(""));
+  }
+
+  SECTION("random") {
+    std::size_t size = GENERATE(1, 63, 64, 65, 200, 1000);
+    std::size_t offset = GENERATE(0, 5);
+    CAPTURE(size, offset);
+
+    std::mt19937 rng(size + offset);
+    std::string source = random_string(size + offset, rng);
+    std::string mask = random_string(size + offset, rng);
+
+    std::string expected;
+    for (std::size_t i = offset; i < source.size(); ++i) {
+      if (mask[i] == '1') {
+        expected.push_back(source[i]);
+      }
+    }
+
+    const bitset source_bs(source);
+    const bitset mask_bs(mask);
+    CHECK_THAT(extract(source_bs.subview(offset), mask_bs.subview(offset)), bitset_equals_string(expected));
+  }
+}
+
+TEST_CASE("deposit") {
+  SECTION("simple") {
+    CHECK_THAT(deposit(bitset("101"), bitset("11001")), bitset_equals_string("10001"));
+    CHECK_THAT(deposit(bitset("1"), bitset("000")), bitset_equals_string("000"));
+  }
+
+  SECTION("random") {
+    std::size_t size = GENERATE(1, 63, 64, 65, 200, 1000);
+    std::size_t offset = GENERATE(0, 5);
+    CAPTURE(size, offset);
+
+    std::mt19937 rng(size + offset);
+    std::string dense = random_string(size + offset, rng);
+    std::string mask = random_string(size + offset, rng);
+
+    std::string expected;
+    std::size_t dense_pos = offset;
+    for (std::size_t i = offset; i < mask.size(); ++i) {
+      expected.push_back(mask[i] == '1' ? dense[dense_pos++] : '0');
+    }
+
+    const bitset dense_bs(dense);
+    const bitset mask_bs(mask);
+    const bitset res = deposit(dense_bs.subview(offset), mask_bs.subview(offset));
+    CHECK_THAT(res, bitset_equals_string(expected));
+    CHECK(extract(res, mask_bs.subview(offset)) == dense_bs.subview(offset, mask_bs.subview(offset).count()));
+  }
+}
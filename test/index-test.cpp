@@ -0,0 +1,130 @@
+#include "bitmap-index.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+bitset brute_force(const std::vector<uint64_t>& values, const std::function<bool(uint64_t)>& matches) {
+  bitset res(values.size(), false);
+  for (std::size_t row = 0; row < values.size(); ++row) {
+    if (matches(values[row])) {
+      res.set(row);
+    }
+  }
+  return res;
+}
+
+template <class Index>
+void check_queries(const Index& index, const std::vector<uint64_t>& values, uint64_t max_value) {
+  REQUIRE(index.rows() == values.size());
+  for (uint64_t v = 0; v <= max_value + 1; ++v) {
+    REQUIRE(index.equal(v) == brute_force(values, [v](uint64_t x) { return x == v; }));
+    REQUIRE(index.less(v) == brute_force(values, [v](uint64_t x) { return x < v; }));
+    REQUIRE(index.between(v, v + 3) == brute_force(values, [v](uint64_t x) { return v <= x && x <= v + 3; }));
+  }
+  CHECK(index.between(5, 2).count() == 0);
+  CHECK(index.less(0).count() == 0);
+
+  std::vector<uint64_t> keys = {1, 4, 4, max_value, max_value + 10};
+  CHECK(index.in(keys) ==
+        brute_force(values, [max_value](uint64_t x) { return x == 1 || x == 4 || x == max_value; }));
+  CHECK(index.in({}).count() == 0);
+
+  CHECK(evaluate(index, predicate::equal(3)) == index.equal(3));
+  CHECK(evaluate(index, predicate::less(3)) == index.less(3));
+  CHECK(evaluate(index, predicate::between(2, 6)) == index.between(2, 6));
+  CHECK(evaluate(index, predicate::in(keys)) == index.in(keys));
+  CHECK(evaluate(index, predicate::between(5, 2)).count() == 0);
+
+  // Connectives, compared with the rows matched one by one
+  predicate composite = predicate::disjunction(
+      {predicate::conjunction({predicate::less(max_value), predicate::negation(predicate::equal(1))}),
+       predicate::negation(predicate::between(1, max_value)),
+       predicate::in({max_value, max_value + 1})}
+  );
+  CHECK(evaluate(index, composite) == brute_force(values, [max_value](uint64_t x) {
+          return (x < max_value && x != 1) || !(1 <= x && x <= max_value) || x == max_value;
+        }));
+  CHECK(evaluate(index, predicate::negation(predicate::in(keys))) == ~index.in(keys));
+  CHECK(evaluate(index, predicate::conjunction({})) == bitset(values.size(), true));
+  CHECK(evaluate(index, predicate::disjunction({})) == bitset(values.size(), false));
+}
+
+} // namespace
+
+TEST_CASE("bitmap indexes") {
+  std::size_t rows = GENERATE(0, 1, 63, 64, 1000);
+  uint64_t max_value = GENERATE(0, 1, 20);
+  std::mt19937 rng(static_cast<unsigned>(rows * 100 + max_value));
+  std::uniform_int_distribution<uint64_t> value(0, max_value);
+  std::vector<uint64_t> values(rows);
+  for (uint64_t& v : values) {
+    v = value(rng);
+  }
+
+  SECTION("equality") {
+    equality_index index(values);
+    CHECK(index.cardinality() <= max_value + 1);
+    check_queries(index, values, max_value);
+  }
+  SECTION("range") {
+    range_index index(values);
+    check_queries(index, values, max_value);
+  }
+  SECTION("bit-sliced") {
+    bit_sliced_index index(values);
+    CHECK(index.slice_count() <= 5);
+    check_queries(index, values, max_value);
+  }
+}
+
+TEST_CASE("bit-sliced index with wide values") {
+  std::vector<uint64_t> values = {0, UINT64_MAX, uint64_t(1) << 63, 12345};
+  bit_sliced_index index(values);
+  CHECK(index.slice_count() == 64);
+  CHECK(index.equal(UINT64_MAX) == bitset("0100"));
+  CHECK(index.less(uint64_t(1) << 63) == bitset("1001"));
+  CHECK(index.between(1, UINT64_MAX) == bitset("0111"));
+  CHECK((index.less(100) & index.in(std::vector<uint64_t>{0, 12345})) == bitset("1000"));
+}
+
+TEST_CASE("bitmap index benchmark", "[!benchmark]") {
+  constexpr std::size_t ROWS = 100'000'000;
+  constexpr uint64_t MAX_VALUE = 31;
+  std::mt19937_64 rng(38);
+  std::uniform_int_distribution<uint64_t> value(0, MAX_VALUE);
+  std::vector<uint64_t> values(ROWS);
+  for (uint64_t& v : values) {
+    v = value(rng);
+  }
+
+  predicate range = predicate::between(4, 20);
+  predicate composite = predicate::disjunction(
+      {predicate::conjunction({predicate::between(4, 20), predicate::negation(predicate::equal(7))}),
+       predicate::in({1, 25, 30})}
+  );
+  auto run = [&](const auto& index) {
+    BENCHMARK("between") {
+      return evaluate(index, range);
+    };
+    BENCHMARK("between and not equal, or in") {
+      return evaluate(index, composite);
+    };
+  };
+
+  SECTION("equality") {
+    run(equality_index(values));
+  }
+  SECTION("range") {
+    run(range_index(values));
+  }
+  SECTION("bit-sliced") {
+    run(bit_sliced_index(values));
+  }
+}
@@ -0,0 +1,103 @@
+#include "bitset.h"
+
+#include "test-helpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Reference layout of bit `i` of external bytes
+bool external_bit(const std::vector<std::byte>& bytes, std::size_t i, bit_order order) {
+  std::size_t shift = order == bit_order::msb_first ? 7 - i % 8 : i % 8;
+  return ((std::to_integer<unsigned>(bytes[i / 8]) >> shift) & 1) != 0;
+}
+
+uint64_t swap_bytes(uint64_t word) {
+  uint64_t res = 0;
+  for (std::size_t i = 0; i < 8; ++i) {
+    res = (res << 8) | ((word >> (8 * i)) & 0xff);
+  }
+  return res;
+}
+
+} // namespace
+
+TEST_CASE("bitset raw words") {
+  bitset bs("1010000000000000000000000000000000000000000000000000000000000001" "11");
+  CHECK(bs.words().size() == 2);
+  CHECK(bs.data() == bs.words().data());
+  CHECK(bs.words()[0] == 0xa000000000000001);
+  CHECK((bs.words()[1] >> 62) == 3);
+
+  bs.words()[0] = 0;
+  CHECK(bs.count() == 2);
+  CHECK(bitset().words().empty());
+}
+
+TEST_CASE("bitset word access by index") {
+  bitset bs(130, true);
+  CHECK(bs.word_count() == 3);
+  CHECK(bs.load_word(1) == ~bitset::word_type(0));
+  // Bits after the end read as zeros whatever the storage holds
+  CHECK(bs.load_word(2) == bitset::word_type(3) << 62);
+
+  bs.store_word(0, 0x8000000000000001);
+  CHECK(bs.count() == 66 + 2);
+  CHECK(bs.test(0));
+  CHECK(bs.test(63));
+
+  bitset::view view = bs.subview(63);
+  CHECK(view.word_count() == 2);
+  CHECK(view.load_word(0) == ~bitset::word_type(0));
+  CHECK(view.load_word(1) == bitset::word_type(7) << 61);
+  view.store_word(1, 0);
+  CHECK(bs.count() == 68 - 3);
+  CHECK(bs.test(126));
+  CHECK_FALSE(bs.test(127));
+}
+
+TEST_CASE("bitset byte conversions") {
+  const bitset bs("1000000011");
+  CHECK(bs.to_bytes() == std::vector{std::byte{0x80}, std::byte{0xc0}});
+  CHECK(bs.to_bytes(bit_order::lsb_first) == std::vector{std::byte{0x01}, std::byte{0x03}});
+  CHECK(bitset::from_bytes(std::vector{std::byte{0x01}, std::byte{0xff}}, 10, bit_order::lsb_first) == bs);
+  CHECK(bitset::from_bytes(std::vector{std::byte{0x80}, std::byte{0xc0}}, 10) == bs);
+
+  std::vector<uint64_t> lsb_words = {0b101, 0x8000000000000000};
+  CHECK_THAT(bitset::from_words(lsb_words, 3, bit_order::lsb_first), bitset_equals_string("101"));
+  CHECK(bitset::from_words(lsb_words, 128, bit_order::lsb_first).find_next(3) == 127);
+}
+
+TEST_CASE("bitset conversions round trip") {
+  std::size_t size = GENERATE(0, 1, 7, 8, 9, 63, 64, 65, 255, 256, 1000, 4099);
+  auto order = GENERATE(bit_order::msb_first, bit_order::lsb_first);
+  CAPTURE(size, order);
+  std::mt19937_64 rng(size);
+  bitset bs = random_bitset(size, rng, 1.0 / 3);
+
+  std::vector<std::byte> bytes = bs.to_bytes(order);
+  REQUIRE(bytes.size() == (size + 7) / 8);
+  for (std::size_t i = 0; i < bytes.size() * 8; ++i) {
+    CAPTURE(i);
+    REQUIRE(external_bit(bytes, i, order) == (i < size && bs[i]));
+  }
+  CHECK(bitset::from_bytes(bytes, size, order) == bs);
+
+  auto byte_order = GENERATE(std::endian::little, std::endian::big);
+  std::vector<uint64_t> words((size + 63) / 64, 42);
+  bs.to_words(words, order, byte_order);
+  for (std::size_t i = 0; i < words.size() * 64; ++i) {
+    uint64_t word = byte_order == std::endian::native ? words[i / 64] : swap_bytes(words[i / 64]);
+    std::size_t shift = order == bit_order::msb_first ? 63 - i % 64 : i % 64;
+    CAPTURE(i);
+    REQUIRE(((word >> shift) & 1) == (i < size && bs[i]));
+  }
+  CHECK(bitset::from_words(words, size, order, byte_order) == bs);
+}
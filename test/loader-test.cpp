@@ -0,0 +1,232 @@
+#include "bitset-loader.h"
+#include "bitset-stream.h"
+#include "test-helpers.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <atomic>
+#include <coroutine>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+bitset load_sync(bitset_loader& loader, const std::string& path) {
+  std::exception_ptr error;
+  bitset res;
+  loader.load(path, [&](std::exception_ptr e, bitset bs) {
+    error = e;
+    res = std::move(bs);
+  });
+  loader.wait();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return res;
+}
+
+void store_sync(bitset_loader& loader, const std::string& path, const bitset& bs) {
+  std::exception_ptr error;
+  loader.store(path, bs, [&](std::exception_ptr e) { error = e; });
+  loader.wait();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+// Drives an awaitable the way `co_await` does, with a no-op coroutine to resume. A coroutine
+// body of our own would trip GCC 12's -Wzero-as-null-pointer-constant on its generated frame.
+template <class Awaitable>
+auto await_blocking(bitset_loader& loader, Awaitable&& awaitable) {
+  if (!awaitable.await_ready()) {
+    awaitable.await_suspend(std::noop_coroutine());
+  }
+  loader.wait();
+  return awaitable.await_resume();
+}
+
+} // namespace
+
+TEST_CASE("bitset loader round trip") {
+  auto kind = GENERATE(bitset_loader::backend::automatic, bitset_loader::backend::thread_pool);
+  std::size_t size = GENERATE(0, 1, 64, 65, 1000, std::size_t(70) << 20);
+  std::mt19937 rng(static_cast<unsigned>(size));
+  bitset expected = size > 100000 ? bitset(size, true) : random_bitset(size, rng, 0.3);
+  if (size > 100000) {
+    expected.reset(size - 1);
+    expected.reset(12345);
+  }
+  std::string path = temp_path("loader-round-trip");
+
+  bitset_loader loader(kind);
+  if (kind == bitset_loader::backend::thread_pool) {
+    CHECK_FALSE(loader.uses_io_uring());
+  }
+  store_sync(loader, path, expected);
+  CHECK(std::filesystem::file_size(path) == (size + 63) / 64 * 8 + 8);
+  CHECK(load_sync(loader, path) == expected);
+
+  // Interchangeable with the stream writer
+  {
+    bitset_stream_writer writer(path);
+    writer.append(expected);
+  }
+  CHECK(load_sync(loader, path) == expected);
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("bitset loader zeroes padding") {
+  auto kind = GENERATE(bitset_loader::backend::automatic, bitset_loader::backend::thread_pool);
+  // Either way the storage keeps ones after the last bit
+  bool shifted = GENERATE(false, true);
+  bitset bs(shifted ? 190 : 130, true);
+  if (shifted) {
+    bs >>= 60;
+  }
+  REQUIRE(bs.size() == 130);
+  std::string path = temp_path("loader-padding");
+
+  bitset_loader loader(kind);
+  store_sync(loader, path, bs);
+  std::ifstream in(path, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  REQUIRE(bytes.size() == 4 * 8);
+  // Bits 128 and 129 are the two most significant bits of the little-endian third word
+  for (std::size_t i = 16; i < 23; ++i) {
+    CHECK(bytes[i] == 0);
+  }
+  CHECK(static_cast<unsigned char>(bytes[23]) == 0xc0);
+  CHECK(load_sync(loader, path) == bs);
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("bitset loader concurrent loads") {
+  auto kind = GENERATE(bitset_loader::backend::automatic, bitset_loader::backend::thread_pool);
+  std::mt19937 rng(7);
+  std::vector<bitset> expected;
+  std::vector<std::string> paths;
+  bitset_loader loader(kind, 4, 3);
+  for (std::size_t i = 0; i < 16; ++i) {
+    expected.push_back(random_bitset(rng() % 5000, rng, 0.3));
+    paths.push_back(temp_path("loader-concurrent-" + std::to_string(i)));
+    store_sync(loader, paths.back(), expected.back());
+  }
+
+  std::mutex mutex;
+  std::vector<bitset> loaded(paths.size());
+  std::atomic<std::size_t> errors = 0;
+  for (std::size_t round = 0; round < 4; ++round) {
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      loader.load(paths[i], [&, i](std::exception_ptr error, bitset bs) {
+        if (error) {
+          ++errors;
+        }
+        std::lock_guard lock(mutex);
+        loaded[i] = std::move(bs);
+      });
+    }
+  }
+  loader.wait();
+  CHECK(errors == 0);
+  CHECK(loaded == expected);
+
+  for (const std::string& path : paths) {
+    std::remove(path.c_str());
+  }
+}
+
+TEST_CASE("bitset loader errors") {
+  auto kind = GENERATE(bitset_loader::backend::automatic, bitset_loader::backend::thread_pool);
+  bitset_loader loader(kind);
+  std::string path = temp_path("loader-errors");
+
+  CHECK_THROWS_AS(load_sync(loader, temp_path("loader-missing")), std::system_error);
+  CHECK_THROWS_AS(store_sync(loader, temp_path("loader-missing-dir") + "/file", bitset(10, true)), std::system_error);
+
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "abc";
+  }
+  CHECK_THROWS_AS(load_sync(loader, path), std::invalid_argument);
+
+  // One data word, but the trailer claims 65 bits
+  {
+    std::ofstream out(path, std::ios::binary);
+    std::string data(8, '\xff');
+    data += std::string("\x41\0\0\0\0\0\0\0", 8);
+    out << data;
+  }
+  CHECK_THROWS_AS(load_sync(loader, path), std::invalid_argument);
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("bitset loader awaitables") {
+  auto kind = GENERATE(bitset_loader::backend::automatic, bitset_loader::backend::thread_pool);
+  std::mt19937 rng(3);
+  bitset expected = random_bitset(10000, rng, 0.3);
+  std::string from = temp_path("loader-coroutine-from");
+  std::string to = temp_path("loader-coroutine-to");
+
+  {
+    bitset_loader loader(kind);
+    store_sync(loader, from, expected);
+    bitset copy = await_blocking(loader, loader.load_async(from));
+    CHECK(copy == expected);
+    await_blocking(loader, loader.store_async(to, copy));
+    CHECK(load_sync(loader, to) == expected);
+    CHECK_THROWS_AS(await_blocking(loader, loader.load_async(from + ".missing")), std::system_error);
+  }
+
+  std::remove(from.c_str());
+  std::remove(to.c_str());
+}
+
+TEST_CASE("bitset loader benchmark", "[!benchmark]") {
+  constexpr std::size_t SNAPSHOTS = 64;
+  constexpr std::size_t SIZE = std::size_t(1) << 26;
+  auto kind = bitset_loader::backend::automatic;
+  SECTION("io_uring where available") {}
+  SECTION("thread pool") {
+    kind = bitset_loader::backend::thread_pool;
+  }
+  bitset_loader loader(kind);
+
+  std::vector<std::string> paths;
+  for (std::size_t i = 0; i < SNAPSHOTS; ++i) {
+    paths.push_back(temp_path("loader-benchmark-" + std::to_string(i)));
+    store_sync(loader, paths.back(), bitset::filled(SIZE, 0x0123456789abcdef + i));
+  }
+
+  BENCHMARK("one at a time") {
+    std::size_t res = 0;
+    for (const std::string& path : paths) {
+      res += load_sync(loader, path).size();
+    }
+    return res;
+  };
+  BENCHMARK("all concurrently") {
+    std::atomic<std::size_t> res = 0;
+    for (const std::string& path : paths) {
+      loader.load(path, [&res](std::exception_ptr, bitset bs) { res += bs.size(); });
+    }
+    loader.wait();
+    return res.load();
+  };
+
+  for (const std::string& path : paths) {
+    std::remove(path.c_str());
+  }
+}
@@ -0,0 +1,105 @@
+#include "bit-matrix.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+bit_matrix make_random(std::size_t rows, std::size_t cols, std::mt19937& rng) {
+  bit_matrix res(rows, cols, false);
+  std::bernoulli_distribution bit(0.5);
+  for (std::size_t i = 0; i < rows; ++i) {
+    for (std::size_t j = 0; j < cols; ++j) {
+      res.set(i, j, bit(rng));
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+TEST_CASE("bit_matrix construction") {
+  bit_matrix empty;
+  CHECK(empty.empty());
+  CHECK(empty.rows() == 0);
+  CHECK(empty.cols() == 0);
+
+  bit_matrix ones(3, 70, true);
+  CHECK(ones.rows() == 3);
+  CHECK(ones.cols() == 70);
+  for (std::size_t i = 0; i < 3; ++i) {
+    CHECK(ones.row(i).all());
+    CHECK(ones.row_count(i) == 70);
+  }
+  CHECK(ones.column(69).all());
+  CHECK(ones.transpose().transpose() == ones);
+}
+
+TEST_CASE("bit_matrix rows and columns") {
+  bit_matrix m(5, 100, false);
+  m.set(1, 0, true).set(1, 99, true).set(4, 64, true);
+  CHECK(m.test(1, 0));
+  CHECK(m.test(1, 99));
+  CHECK_FALSE(m.test(0, 0));
+  CHECK(m.row_count(1) == 2);
+  CHECK(m.row(4).count() == 1);
+
+  m.row(2).set();
+  CHECK(m.row_count(2) == 100);
+  CHECK(m.row_count(3) == 0);
+
+  bitset col = m.column(64);
+  CHECK(col.size() == 5);
+  CHECK(col == bitset("00101"));
+
+  m.row(2).reset();
+  m.set(4, 64, false);
+  CHECK_FALSE(m.column(64).any());
+}
+
+TEST_CASE("bit_matrix transpose") {
+  std::size_t rows = GENERATE(1, 7, 63, 64, 65, 130);
+  std::size_t cols = GENERATE(1, 31, 64, 100, 129);
+  std::mt19937 rng(static_cast<unsigned>(rows * 1000 + cols));
+  bit_matrix m = make_random(rows, cols, rng);
+
+  bit_matrix t = m.transpose();
+  REQUIRE(t.rows() == cols);
+  REQUIRE(t.cols() == rows);
+  for (std::size_t i = 0; i < rows; ++i) {
+    for (std::size_t j = 0; j < cols; ++j) {
+      REQUIRE(t.test(j, i) == m.test(i, j));
+    }
+  }
+  for (std::size_t j = 0; j < cols; ++j) {
+    REQUIRE(bitset(t.row(j)) == m.column(j));
+  }
+  REQUIRE(t.transpose() == m);
+}
+
+TEST_CASE("bit_matrix and_count") {
+  std::mt19937 rng(42);
+  bit_matrix m = make_random(20, 150, rng);
+  bitset vec(150, false);
+  for (std::size_t j = 0; j < 150; j += 3) {
+    vec.set(j);
+  }
+
+  std::vector<std::size_t> counts = m.and_count(vec);
+  REQUIRE(counts.size() == 20);
+  for (std::size_t i = 0; i < 20; ++i) {
+    CHECK(counts[i] == (m.row(i) & vec).count());
+  }
+}
+
+TEST_CASE("bit_matrix comparison") {
+  bit_matrix a(4, 10, false);
+  bit_matrix b(4, 10, false);
+  CHECK(a == b);
+  b.set(3, 9, true);
+  CHECK(a != b);
+  CHECK(bit_matrix(2, 3, false) != bit_matrix(3, 2, false));
+}
@@ -7,7 +7,11 @@
 
 #include <algorithm>
 #include <array>
+#include <random>
+#include <string>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 TEST_CASE("left shift") {
   SECTION("empty") {
@@ -107,6 +111,72 @@ TEST_CASE("right shift") {
   }
 }
 
+TEST_CASE("insert") {
+  std::string str = GENERATE(
+      std::string(""),
+      std::string("1101101"),
+      std::string("11110110111010000100101111101000011011111111000001100110010010001011100100110101")
+  );
+  CAPTURE(str);
+  bitset bs(str);
+
+  SECTION("count and value") {
+    std::size_t pos = GENERATE(0, 3, 64, 1000);
+    std::size_t count = GENERATE(0, 1, 5, 64, 130);
+    bool value = GENERATE(false, true);
+    pos = std::min(pos, str.size());
+    CAPTURE(pos, count, value);
+
+    bs.insert(pos, count, value);
+    str.insert(pos, count, value ? '1' : '0');
+    CHECK_THAT(bs, bitset_equals_string(str));
+  }
+
+  SECTION("view") {
+    std::string other = "0110111010000100101111101000011011111111000001100110010010001011100100110101110110";
+    std::size_t pos = GENERATE(0, 3, 64, 1000);
+    std::size_t offset = GENERATE(0, 1, 64);
+    std::size_t count = GENERATE(0, 1, 5, 63, 64);
+    pos = std::min(pos, str.size());
+    CAPTURE(pos, offset, count);
+
+    bitset other_bs(other);
+    bs.insert(pos, other_bs.subview(offset, count));
+    str.insert(pos, other.substr(offset, count));
+    CHECK_THAT(bs, bitset_equals_string(str));
+  }
+
+  SECTION("aliasing view") {
+    std::size_t pos = GENERATE(0, 3, 1000);
+    pos = std::min(pos, str.size());
+    CAPTURE(pos);
+
+    bs.insert(pos, std::as_const(bs).subview(1));
+    str.insert(pos, str.empty() ? "" : str.substr(1));
+    CHECK_THAT(bs, bitset_equals_string(str));
+  }
+}
+
+TEST_CASE("erase") {
+  std::string str = GENERATE(
+      std::string("1101101"),
+      std::string("11110110111010000100101111101000011011111111000001100110010010001011100100110101"),
+      std::string(
+          "11110110111010000100101111101000011011111111000001100110010010001011100100110101"
+          "01101110100001001011111010000110111111110000011001100100100010111001001101011101"
+      )
+  );
+  std::size_t pos = GENERATE(0, 3, 64, 100);
+  std::size_t count = GENERATE(0, 1, 5, 64, 70, bitset::npos);
+  pos = std::min(pos, str.size());
+  CAPTURE(str, pos, count);
+
+  bitset bs(str);
+  bs.erase(pos, count);
+  str.erase(pos, count);
+  CHECK_THAT(bs, bitset_equals_string(str));
+}
+
 TEST_CASE("bitwise operations") {
   SECTION("empty") {
     bitset bs;
@@ -273,6 +343,80 @@ TEST_CASE("bitwise operations") {
   }
 }
 
+TEST_CASE("single bit set/reset/flip/test") {
+  std::string str = "11110110111010000100101111101000011011111111000001100110010010001011100100110101";
+  bitset bs(str);
+
+  std::size_t pos = GENERATE(0, 1, 63, 64, 79);
+  CAPTURE(pos);
+
+  CHECK(std::as_const(bs).test(pos) == (str[pos] == '1'));
+
+  bs.set(pos);
+  str[pos] = '1';
+  CHECK_THAT(bs, bitset_equals_string(str));
+
+  bs.flip(pos);
+  str[pos] = '0';
+  CHECK_THAT(bs, bitset_equals_string(str));
+  CHECK_FALSE(bs.test(pos));
+
+  bs.flip(pos).reset(pos);
+  CHECK_THAT(bs, bitset_equals_string(str));
+}
+
+TEST_CASE("range set/reset/flip") {
+  std::string str = "11110110111010000100101111101000011011111111000001100110010010001011100100110101"
+                    "01101110100001001011111010000110111111110000011001100100100010111001001101011101";
+  bitset bs(str);
+
+  std::size_t first = GENERATE(0, 1, 63, 64, 100);
+  std::size_t length = GENERATE(0, 1, 2, 63, 64, 65, 60);
+  std::size_t last = std::min(first + length, str.size());
+  CAPTURE(first, last);
+
+  SECTION("set") {
+    bool value = GENERATE(false, true);
+    CAPTURE(value);
+
+    bs.set(first, last, value);
+    std::fill(str.begin() + first, str.begin() + last, value ? '1' : '0');
+    CHECK_THAT(bs, bitset_equals_string(str));
+  }
+
+  SECTION("reset") {
+    bs.reset(first, last);
+    std::fill(str.begin() + first, str.begin() + last, '0');
+    CHECK_THAT(bs, bitset_equals_string(str));
+  }
+
+  SECTION("flip") {
+    bs.flip(first, last);
+    std::for_each(str.begin() + first, str.begin() + last, [](char& c) { c = (c == '1' ? '0' : '1'); });
+    CHECK_THAT(bs, bitset_equals_string(str));
+  }
+}
+
+TEST_CASE("set_indices") {
+  std::vector<std::size_t> indices = {150, 3, 64, 0, 63, 65, 3, 149, 127};
+  bitset bs(151, false);
+  bs.set_indices(indices);
+
+  std::string str(151, '0');
+  for (std::size_t i : indices) {
+    str[i] = '1';
+  }
+  CHECK_THAT(bs, bitset_equals_string(str));
+
+  std::ranges::sort(indices);
+  bitset sorted(151, false);
+  sorted.set_indices(indices);
+  CHECK(sorted == bs);
+
+  bs.set_indices({});
+  CHECK_THAT(bs, bitset_equals_string(str));
+}
+
 TEST_CASE("bitset::all/any/count") {
   SECTION("empty") {
     bitset bs;
@@ -360,6 +504,99 @@ TEST_CASE("bitset comparison") {
   }
 }
 
+TEST_CASE("bitset ordering") {
+  std::array strings = {
+      "",
+      "0",
+      "1",
+      "10110",
+      "101101",
+      "10111",
+      "1111011011101000010010111110100001101111111100000110011001001",
+      "11110110111010000100101111101000011011111111000001100110010010000000000000000000",
+      "11110110111010000100101111101000011011111111000001100110010010001011100100110101",
+  };
+  std::string_view str_1 = GENERATE_REF(from_range(strings));
+  std::string_view str_2 = GENERATE_REF(from_range(strings));
+  CAPTURE(str_1, str_2);
+
+  const bitset bs_1(str_1);
+  const bitset bs_2(str_2);
+
+  CHECK((bs_1 <=> bs_2) == (str_1 <=> str_2));
+  CHECK((bs_1 < bs_2) == (str_1 < str_2));
+  CHECK((bs_1 >= bs_2) == (str_1 >= str_2));
+
+  auto [it_1, it_2] = std::ranges::mismatch(str_1, str_2);
+  std::size_t expected = (str_1 == str_2) ? bitset::npos : static_cast<std::size_t>(it_1 - str_1.begin());
+  CHECK(first_mismatch(bs_1, bs_2) == expected);
+}
+
+TEST_CASE("first_mismatch") {
+  bitset bs_1(300, false);
+  bitset bs_2(300, false);
+  CHECK(first_mismatch(bs_1, bs_2) == bitset::npos);
+
+  std::size_t pos = GENERATE(0, 1, 63, 64, 130, 299);
+  CAPTURE(pos);
+  bs_2[pos] = true;
+
+  CHECK(first_mismatch(bs_1, bs_2) == pos);
+  CHECK(bs_1 < bs_2);
+
+  SECTION("unaligned views") {
+    std::size_t offset = GENERATE(0, 3);
+    bitset shifted = bitset(std::string(offset, '1')) << bs_2.size();
+    shifted.subview(offset) |= bs_2;
+
+    CHECK(first_mismatch(shifted.subview(offset), bs_1) == pos);
+    CHECK(first_mismatch(shifted.subview(offset), bs_2) == bitset::npos);
+    CHECK(shifted.subview(offset) == bs_2);
+  }
+}
+
+TEST_CASE("bitset hash") {
+  std::string_view str = "11110110111010000100101111101000011011111111000001100110010010001011100100110101"
+                         "0110100101110001010110011100101011111000100100001011101011001011101010010110";
+  const bitset bs(str);
+  std::hash<bitset::const_view> hash;
+
+  SECTION("equal bitsets") {
+    const bitset copy(bs);
+    CHECK(std::hash<bitset>()(copy) == std::hash<bitset>()(bs));
+    CHECK(hash(copy) == std::hash<bitset>()(bs));
+  }
+
+  SECTION("views at different offsets") {
+    std::size_t size = GENERATE(0, 1, 63, 64, 65, 100);
+    std::size_t offset = GENERATE(0, 1, 13, 64);
+    CAPTURE(size, offset);
+
+    bitset shifted(std::string(offset, '1') + std::string(str));
+    const bitset expected(str.substr(0, size));
+
+    CHECK(hash(shifted.subview(offset, size)) == hash(expected));
+    CHECK(std::hash<bitset::view>()(shifted.subview(offset, size)) == hash(expected));
+  }
+
+  SECTION("different bitsets") {
+    bitset other(bs);
+    other[100].flip();
+    CHECK(hash(other) != hash(bs));
+    CHECK(hash(bs.subview(0, 10)) != hash(bs.subview(0, 11)));
+    CHECK(hash(bitset(5, false)) != hash(bitset(6, false)));
+  }
+
+  SECTION("unordered_set") {
+    std::unordered_set<bitset> set;
+    set.insert(bs);
+    set.insert(bitset(bs.subview(1)));
+    set.insert(bitset(str));
+    CHECK(set.size() == 2);
+    CHECK(set.contains(bitset(str)));
+  }
+}
+
 TEST_CASE("view operations") {
   bitset bs("1110010101");
 
@@ -412,3 +649,71 @@ TEST_CASE("chained view operations") {
   CHECK(bs_1 == bitset("0010000001"));
   CHECK(bs_2 == bitset("1110010101"));
 }
+
+TEST_CASE("out-of-place operations") {
+  std::size_t size = GENERATE(0, 1, 63, 64, 65, 300);
+  std::size_t dst_offset = GENERATE(0, 5, 64);
+  std::size_t src_offset = GENERATE(0, 3);
+  CAPTURE(size, dst_offset, src_offset);
+
+  std::mt19937 rng(static_cast<unsigned>(size));
+  bitset left = random_bitset(src_offset + size, rng);
+  bitset right = random_bitset(size, rng);
+  bitset::const_view left_view = std::as_const(left).subview(src_offset);
+
+  // Expected results are built bit by bit, independently of the word kernels
+  auto per_bit = [size](auto op) {
+    std::string res(size, '0');
+    for (std::size_t i = 0; i < size; ++i) {
+      res[i] = op(i) ? '1' : '0';
+    }
+    return res;
+  };
+
+  // The bits of `dst` around the result must stay untouched
+  bitset dst(dst_offset + size + 10, true);
+  bitset::view dst_view = dst.subview(dst_offset, size);
+  auto check_result = [&](const std::string& expected) {
+    CHECK_THAT(bitset(dst_view), bitset_equals_string(expected));
+    CHECK(dst.subview(0, dst_offset).all());
+    CHECK(dst.subview(dst_offset + size).all());
+  };
+
+  bitwise_and(dst_view, left_view, right);
+  check_result(per_bit([&](std::size_t i) { return left_view[i] && right[i]; }));
+  bitwise_or(dst_view, left_view, right);
+  check_result(per_bit([&](std::size_t i) { return left_view[i] || right[i]; }));
+  bitwise_xor(dst_view, left_view, right);
+  check_result(per_bit([&](std::size_t i) { return left_view[i] != right[i]; }));
+  bitwise_andnot(dst_view, left_view, right);
+  check_result(per_bit([&](std::size_t i) { return left_view[i] && !right[i]; }));
+  bitwise_not(dst_view, left_view);
+  check_result(per_bit([&](std::size_t i) { return !left_view[i]; }));
+
+  // In place: `dst` is an operand
+  std::string expected = per_bit([&](std::size_t i) { return dst_view[i] != right[i]; });
+  bitwise_xor(dst_view, dst_view, right);
+  check_result(expected);
+  expected = per_bit([&](std::size_t i) { return !dst_view[i]; });
+  bitwise_not(dst_view, dst_view);
+  check_result(expected);
+}
+
+TEST_CASE("out-of-place shifts") {
+  bitset bs("1011001");
+  bitset dst(10, true);
+
+  shift_left(dst, bs, 3);
+  CHECK(dst == bitset("1011001000"));
+  shift_left(dst.subview(1, 8), bs, 1);
+  CHECK(dst == bitset("1101100100"));
+  shift_right(dst.subview(0, 4), bs, 3);
+  CHECK(dst == bitset("1011100100"));
+  shift_right(bitset::view(), bs, 10);
+
+  // The source is the prefix of the destination
+  bitset prefix("110");
+  bitset grown = prefix << 2;
+  shift_left(grown, grown.subview(0, 3), 2);
+  CHECK(grown == bitset("11000"));
+}
@@ -0,0 +1,109 @@
+#include "bitset.h"
+#include "test-helpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+using lsb_view = bitset_view<uint64_t, bit_order::lsb_first>;
+using lsb_const_view = bitset_view<const uint64_t, bit_order::lsb_first>;
+
+std::vector<uint64_t> lsb_words(const bitset& bs) {
+  std::vector<uint64_t> res(bs.words().size());
+  bs.to_words(res, bit_order::lsb_first);
+  return res;
+}
+
+bitset from_lsb(const std::vector<uint64_t>& words, std::size_t size) {
+  return bitset::from_words(words, size, bit_order::lsb_first);
+}
+
+} // namespace
+
+TEST_CASE("lsb_first references and iterators") {
+  std::vector<uint64_t> words = {0b1011, 1};
+  lsb_view view(words.data(), 0, 70);
+
+  CHECK(view[0]);
+  CHECK(view[1]);
+  CHECK_FALSE(view[2]);
+  CHECK(view[64]);
+  view[2] = true;
+  view[64].flip();
+  CHECK(words == std::vector<uint64_t>{0b1111, 0});
+  CHECK(std::count(view.begin(), view.end(), true) == 4);
+
+  lsb_const_view tail(words.data(), 2, 10);
+  CHECK(tail.count() == 2);
+  CHECK(tail.find_first() == 0);
+  CHECK(tail.find_next(2) == lsb_const_view::npos);
+  CHECK(tail.read_word(0, 3) == 0b011);
+}
+
+TEST_CASE("lsb_first views match msb_first") {
+  std::size_t size = GENERATE(1, 63, 64, 65, 200, 1000);
+  CAPTURE(size);
+  std::mt19937_64 rng(size);
+
+  for (std::size_t iteration = 0; iteration < 50; ++iteration) {
+    bitset lhs = random_bitset(size, rng, 1.0 / 3);
+    bitset rhs = random_bitset(size, rng, 1.0 / 3);
+    std::vector<uint64_t> lhs_words = lsb_words(lhs);
+    std::vector<uint64_t> rhs_words = lsb_words(rhs);
+
+    std::size_t offset = rng() % size;
+    std::size_t count = rng() % (size - offset + 1);
+    std::size_t rhs_offset = rng() % (size - count + 1);
+    CAPTURE(iteration, offset, count, rhs_offset);
+    bitset::view msb = lhs.subview(offset, count);
+    lsb_view lsb(lhs_words.data(), offset, count);
+
+    REQUIRE(lsb.size() == count);
+    REQUIRE(lsb.count() == msb.count());
+    REQUIRE(lsb.all() == msb.all());
+    REQUIRE(lsb.any() == msb.any());
+    std::size_t pos = count == 0 ? 0 : rng() % count;
+    REQUIRE(lsb.find_next(pos) == msb.find_next(pos));
+
+    std::size_t word_count = std::min<std::size_t>(count - pos, rng() % 65);
+    uint64_t word = lsb.read_word(pos, word_count);
+    for (std::size_t i = 0; i < word_count; ++i) {
+      REQUIRE(((word >> i) & 1) == msb[pos + i]);
+    }
+
+    lsb_const_view lsb_rhs(rhs_words.data(), rhs_offset, count);
+    switch (rng() % 6) {
+    case 0:
+      msb &= rhs.subview(rhs_offset, count);
+      lsb &= lsb_rhs;
+      break;
+    case 1:
+      msb |= rhs.subview(rhs_offset, count);
+      lsb |= lsb_rhs;
+      break;
+    case 2:
+      msb ^= rhs.subview(rhs_offset, count);
+      lsb ^= lsb_rhs;
+      break;
+    case 3:
+      msb.flip();
+      lsb.flip();
+      break;
+    case 4:
+      msb.set();
+      lsb.set();
+      break;
+    default:
+      msb.write_word(pos, word_count, rhs.subview().read_word(0, word_count));
+      lsb.write_word(pos, word_count, lsb_const_view(rhs_words.data(), 0, size).read_word(0, word_count));
+      break;
+    }
+    REQUIRE(from_lsb(lhs_words, size) == lhs);
+  }
+}
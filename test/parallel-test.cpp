@@ -0,0 +1,112 @@
+#include "bitset-parallel.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <atomic>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+TEST_CASE("parallel construction") {
+  std::size_t size = GENERATE(0, 100, PARALLEL_MIN_SIZE + 1, 3 * PARALLEL_MIN_SIZE + 77);
+  std::size_t threads = GENERATE(0, 1, 3, 8);
+
+  bitset ones = parallel_bitset(size, true, threads);
+  CHECK(ones.size() == size);
+  CHECK(ones == bitset(size, true));
+  CHECK(parallel_count(ones, threads) == size);
+
+  bitset zeros = parallel_bitset(size, false, threads);
+  CHECK(zeros == bitset(size, false));
+  CHECK(parallel_count(zeros, threads) == 0);
+}
+
+TEST_CASE("parallel binary operations") {
+  std::size_t size = GENERATE(1000, 2 * PARALLEL_MIN_SIZE + 13);
+  std::size_t threads = GENERATE(0, 5);
+
+  bitset lhs(size, false);
+  bitset rhs(size, false);
+  for (std::size_t i = 0; i < size; i += 3) {
+    lhs.set(i);
+  }
+  for (std::size_t i = 0; i < size; i += 5) {
+    rhs.set(i);
+  }
+
+  bitset expected = lhs & rhs;
+  bitset res = lhs;
+  parallel_and(res, rhs, threads);
+  CHECK(res == expected);
+  CHECK(parallel_count(res, threads) == expected.count());
+
+  res = lhs;
+  parallel_or(res, rhs, threads);
+  CHECK(res == (lhs | rhs));
+
+  res = lhs;
+  parallel_xor(res, rhs.subview(), threads);
+  CHECK(res == (lhs ^ rhs));
+
+  CHECK(parallel_count(lhs.subview(7, size - 10), threads) == lhs.subview(7, size - 10).count());
+}
+
+TEST_CASE("parallel chunks") {
+  std::size_t chunks = GENERATE(0, 1, 2, 7);
+
+  std::vector<std::atomic<int>> calls(chunks);
+  parallel_for_chunks(chunks, [&calls](std::size_t chunk) { ++calls[chunk]; });
+  for (const std::atomic<int>& count : calls) {
+    CHECK(count == 1);
+  }
+
+#if defined(__linux__)
+  // A chunk runs on the same CPU in every call
+  std::vector<int> first(chunks);
+  std::vector<int> second(chunks);
+  parallel_for_chunks(chunks, [&first](std::size_t chunk) { first[chunk] = sched_getcpu(); });
+  parallel_for_chunks(chunks, [&second](std::size_t chunk) { second[chunk] = sched_getcpu(); });
+  if (chunks > 1) {
+    CHECK(first == second);
+  }
+#endif
+}
+
+TEST_CASE("parallel benchmark", "[!benchmark]") {
+  constexpr std::size_t SIZE = std::size_t(1) << 32;
+
+  SECTION("construction") {
+    BENCHMARK("one thread") {
+      return bitset(SIZE, true);
+    };
+    BENCHMARK("parallel") {
+      return parallel_bitset(SIZE, true);
+    };
+  }
+
+  // Scans of bitsets placed by one thread and by the matching chunk threads
+  SECTION("placed by one thread") {
+    bitset lhs(SIZE, true);
+    bitset rhs(SIZE, true);
+    BENCHMARK("parallel count") {
+      return parallel_count(lhs);
+    };
+    BENCHMARK("parallel and") {
+      parallel_and(lhs, rhs);
+    };
+  }
+  SECTION("placed by the chunk threads") {
+    bitset lhs = parallel_bitset(SIZE, true);
+    bitset rhs = parallel_bitset(SIZE, true);
+    BENCHMARK("parallel count") {
+      return parallel_count(lhs);
+    };
+    BENCHMARK("parallel and") {
+      parallel_and(lhs, rhs);
+    };
+  }
+}
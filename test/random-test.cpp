@@ -0,0 +1,68 @@
+#include "bitset-parallel.h"
+#include "bitset-random.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+TEST_CASE("xoshiro256") {
+  xoshiro256 lhs(42);
+  xoshiro256 rhs(42);
+  CHECK(lhs == rhs);
+  CHECK(lhs() == rhs());
+  CHECK(xoshiro256(1)() != xoshiro256(2)());
+
+  xoshiro256 jumped = lhs;
+  jumped.jump();
+  CHECK(jumped != lhs);
+  uint64_t mismatches = 0;
+  for (std::size_t i = 0; i < 100; ++i) {
+    mismatches += lhs() != jumped();
+  }
+  CHECK(mismatches == 100);
+}
+
+TEST_CASE("random bitset density") {
+  double density = GENERATE(0.0, 1.0, 0.5, 0.3, 0.75, 0.9, 1.0 / 64, 0.001, 0.999, 1e-6);
+  CAPTURE(density);
+  std::size_t size = (std::size_t(1) << 20) + 77;
+  xoshiro256 rng(7);
+
+  bitset bs = bitset::random(size, rng, density);
+  CHECK(bs.size() == size);
+  double expected = density * size;
+  double sigma = std::sqrt(size * density * (1 - density));
+  CHECK(std::abs(bs.count() - expected) <= 6 * sigma + 1);
+
+  // Neighbours are independent: pairs of ones occur with probability density^2
+  std::size_t pairs = 0;
+  for (std::size_t i = bs.find_first(); i < size - 1; i = bs.find_next(i + 1)) {
+    pairs += bs[i + 1];
+  }
+  double expected_pairs = density * density * (size - 1);
+  CHECK(std::abs(pairs - expected_pairs) <= 6 * std::sqrt(expected_pairs) + 1);
+}
+
+TEST_CASE("random bitset determinism") {
+  std::size_t size = GENERATE(0, 1, 1000, 3 * RANDOM_BLOCK_SIZE + 5, PARALLEL_MIN_SIZE + RANDOM_BLOCK_SIZE / 2);
+  double density = GENERATE(0.5, 0.2, 0.005);
+  CAPTURE(size, density);
+
+  xoshiro256 single(123);
+  bitset expected = bitset::random(size, single, density, 1);
+  for (std::size_t threads : {0, 2, 3, 16}) {
+    CAPTURE(threads);
+    xoshiro256 rng(123);
+    CHECK(bitset::random(size, rng, density, threads) == expected);
+    CHECK(rng == single);
+  }
+
+  // The generator moves on
+  if (size > 0) {
+    xoshiro256 rng(123);
+    bitset first = bitset::random(size, rng, 0.5);
+    CHECK(bitset::random(size, rng, 0.5) != first);
+  }
+}
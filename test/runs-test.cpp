@@ -0,0 +1,118 @@
+#include "bitset-runs.h"
+
+#include "test-helpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::vector<std::pair<std::size_t, std::size_t>> naive_runs(const bitset::const_view& bs, bool value) {
+  std::vector<std::pair<std::size_t, std::size_t>> res;
+  for (std::size_t i = 0; i < bs.size(); ++i) {
+    if (bs[i] != value) {
+      continue;
+    }
+    if (i > 0 && bs[i - 1] == value) {
+      ++res.back().second;
+    } else {
+      res.emplace_back(i, 1);
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+TEST_CASE("prefix scans") {
+  bitset bs("0010010000");
+  bitset copy = bs;
+  prefix_or(copy);
+  CHECK_THAT(copy, bitset_equals_string("0011111111"));
+  prefix_xor(bs);
+  CHECK_THAT(bs, bitset_equals_string("0011100000"));
+
+  bitset zeros(100, false);
+  prefix_or(zeros);
+  CHECK_FALSE(zeros.any());
+}
+
+TEST_CASE("prefix scans match naive") {
+  std::size_t size = GENERATE(1, 63, 64, 65, 300, 1000);
+  double density = GENERATE(0.01, 0.5);
+  CAPTURE(size, density);
+  std::mt19937_64 rng(size);
+  bitset source = random_bitset(size, rng, density);
+
+  for (std::size_t iteration = 0; iteration < 20; ++iteration) {
+    std::size_t offset = rng() % size;
+    std::size_t count = rng() % (size - offset + 1);
+    CAPTURE(offset, count);
+
+    bitset scanned_or = source;
+    bitset scanned_xor = source;
+    prefix_or(scanned_or.subview(offset, count));
+    prefix_xor(scanned_xor.subview(offset, count));
+
+    bool any = false;
+    bool parity = false;
+    for (std::size_t i = 0; i < size; ++i) {
+      bool inside = offset <= i && i < offset + count;
+      any |= inside && source[i];
+      parity ^= inside && source[i];
+      REQUIRE(scanned_or[i] == (inside ? any : source[i]));
+      REQUIRE(scanned_xor[i] == (inside ? parity : source[i]));
+    }
+  }
+}
+
+TEST_CASE("runs") {
+  const bitset bs("0111001100000111");
+  CHECK(longest_run(bs) == 3);
+  CHECK(longest_run(bs, false) == 5);
+  CHECK(count_runs(bs) == 3);
+  CHECK(count_runs(bs, false) == 3);
+  CHECK(find_next_value(bs, 1, false) == 4);
+  CHECK(find_next_value(bs, 11, true) == 13);
+  CHECK(find_next_value(bs, 13, false) == bitset::npos);
+
+  std::vector<std::pair<std::size_t, std::size_t>> runs;
+  for_each_run(bs, [&runs](std::size_t start, std::size_t length) { runs.emplace_back(start, length); });
+  CHECK(runs == std::vector<std::pair<std::size_t, std::size_t>>{{1, 3}, {6, 2}, {13, 3}});
+
+  CHECK(longest_run(bitset()) == 0);
+  CHECK(count_runs(bitset(200, true)) == 1);
+  CHECK(longest_run(bitset(200, true)) == 200);
+  CHECK(longest_run(bitset(200, true), false) == 0);
+}
+
+TEST_CASE("runs match naive") {
+  std::size_t size = GENERATE(1, 64, 65, 500, 3000);
+  double density = GENERATE(0.05, 0.5, 0.97);
+  bool value = GENERATE(false, true);
+  CAPTURE(size, density, value);
+  std::mt19937_64 rng(size);
+  bitset source = random_bitset(size, rng, density);
+
+  for (std::size_t iteration = 0; iteration < 10; ++iteration) {
+    std::size_t offset = rng() % size;
+    std::size_t count = rng() % (size - offset + 1);
+    CAPTURE(offset, count);
+    bitset::const_view view = source.subview(offset, count);
+
+    auto expected = naive_runs(view, value);
+    std::vector<std::pair<std::size_t, std::size_t>> runs;
+    for_each_run(view, [&runs](std::size_t start, std::size_t length) { runs.emplace_back(start, length); }, value);
+    REQUIRE(runs == expected);
+    REQUIRE(count_runs(view, value) == expected.size());
+    std::size_t longest = 0;
+    for (auto [start, length] : expected) {
+      longest = std::max(longest, length);
+    }
+    REQUIRE(longest_run(view, value) == longest);
+  }
+}
@@ -0,0 +1,124 @@
+#include "bit-search.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string random_string(std::size_t size, std::string_view alphabet, std::mt19937& rng) {
+  std::uniform_int_distribution<std::size_t> letter(0, alphabet.size() - 1);
+  std::string res(size, ' ');
+  for (char& c : res) {
+    c = alphabet[letter(rng)];
+  }
+  return res;
+}
+
+std::vector<std::size_t> naive_exact(std::string_view text, std::string_view pattern) {
+  std::vector<std::size_t> res;
+  for (std::size_t pos = text.find(pattern); pos != std::string_view::npos; pos = text.find(pattern, pos + 1)) {
+    res.push_back(pos + pattern.size());
+  }
+  return res;
+}
+
+// Sellers' dynamic programming: ends of substrings within `max_errors` edits of the pattern
+std::vector<std::size_t> naive_approximate(std::string_view text, std::string_view pattern, std::size_t max_errors) {
+  std::vector<std::size_t> res;
+  std::vector<std::size_t> column(pattern.size() + 1);
+  for (std::size_t i = 0; i <= pattern.size(); ++i) {
+    column[i] = i;
+  }
+  for (std::size_t j = 0; j < text.size(); ++j) {
+    std::size_t diagonal = column[0];
+    for (std::size_t i = 1; i <= pattern.size(); ++i) {
+      std::size_t next = std::min({column[i] + 1, column[i - 1] + 1, diagonal + (pattern[i - 1] != text[j])});
+      diagonal = column[i];
+      column[i] = next;
+    }
+    if (column[pattern.size()] <= max_errors) {
+      res.push_back(j + 1);
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+TEST_CASE("bitap exact search") {
+  bitap_matcher matcher("aba");
+  CHECK(matcher.size() == 3);
+  CHECK(matcher.find_all("abababa") == std::vector<std::size_t>{3, 5, 7});
+  CHECK(matcher.find_all("").empty());
+  CHECK(matcher.find_all("ab").empty());
+
+  std::size_t pattern_size = GENERATE(1, 63, 64, 65, 200);
+  std::mt19937 rng(static_cast<unsigned>(pattern_size));
+  std::string pattern = random_string(pattern_size, "ab", rng);
+  std::string text = random_string(2000, "ab", rng);
+  for (std::size_t pos = 100; pos + pattern_size < text.size(); pos += 400) {
+    text.replace(pos, pattern_size, pattern);
+  }
+  std::vector<std::size_t> expected = naive_exact(text, pattern);
+  REQUIRE_FALSE(expected.empty());
+  CHECK(bitap_matcher(pattern).find_all(text) == expected);
+  CHECK(bitap_matcher(pattern).find_all(text, 0) == expected);
+}
+
+TEST_CASE("approximate search") {
+  CHECK(bitap_matcher("hello").find_all("say helo!", 1) == std::vector<std::size_t>{8});
+  CHECK(myers_matcher("hello").find_all("say helo!", 1) == std::vector<std::size_t>{8});
+  CHECK(myers_matcher("hello").find_all("say helo!", 0).empty());
+
+  std::size_t pattern_size = GENERATE(5, 64, 70, 130);
+  std::size_t max_errors = GENERATE(1, 3, 10);
+  std::mt19937 rng(static_cast<unsigned>(pattern_size * 100 + max_errors));
+  std::string pattern = random_string(pattern_size, "acgt", rng);
+  std::string text = random_string(3000, "acgt", rng);
+  std::uniform_int_distribution<std::size_t> edit(0, pattern_size - 1);
+  for (std::size_t pos = 50; pos + pattern_size < text.size(); pos += 500) {
+    std::string occurrence = pattern;
+    for (std::size_t e = 0; e < max_errors / 2; ++e) {
+      occurrence[edit(rng)] = 'x';
+    }
+    occurrence.erase(edit(rng) % occurrence.size(), 1);
+    text.replace(pos, occurrence.size(), occurrence);
+  }
+
+  std::vector<std::size_t> expected = naive_approximate(text, pattern, max_errors);
+  REQUIRE_FALSE(expected.empty());
+  CHECK(myers_matcher(pattern).find_all(text, max_errors) == expected);
+  if (max_errors < pattern_size) {
+    CHECK(bitap_matcher(pattern).find_all(text, max_errors) == expected);
+  }
+  CHECK(myers_matcher(pattern).find_all(text, 0) == naive_exact(text, pattern));
+}
+
+TEST_CASE("search benchmark", "[!benchmark]") {
+  // A multi-megabyte log with a long pattern planted every 64 KiB, a few of them with typos
+  std::mt19937 rng(37);
+  std::string pattern = random_string(200, "abcdefghijklmnopqrstuvwxyz ", rng);
+  std::string text = random_string(std::size_t(4) << 20, "abcdefghijklmnopqrstuvwxyz ", rng);
+  for (std::size_t pos = 0; pos + pattern.size() < text.size(); pos += std::size_t(64) << 10) {
+    text.replace(pos, pattern.size(), pattern);
+    text[pos + pos % pattern.size()] = '_';
+  }
+  bitap_matcher bitap(pattern);
+  myers_matcher myers(pattern);
+
+  BENCHMARK("bitap exact") {
+    return bitap.find_all(text);
+  };
+  BENCHMARK("bitap, 5 errors") {
+    return bitap.find_all(text, 5);
+  };
+  BENCHMARK("myers, 5 errors") {
+    return myers.find_all(text, 5);
+  };
+}
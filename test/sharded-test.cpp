@@ -0,0 +1,78 @@
+#include "sharded-bitset.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("sharded_bitset basics") {
+  bool value = GENERATE(false, true);
+  CAPTURE(value);
+
+  sharded_bitset bs(3000, value, 1000);
+  CHECK(bs.size() == 3000);
+  CHECK(bs.shard_size() == 1024);
+  CHECK(bs.shard_count() == 3);
+  CHECK(bs.count() == (value ? 3000 : 0));
+  CHECK(bs.any() == value);
+  CHECK(bs.all() == value);
+
+  bs.flip(0);
+  bs.set(1500);
+  bs.reset(2999);
+  CHECK(bs.test(0) != value);
+  CHECK(bs.test(1500));
+  CHECK_FALSE(bs.test(2999));
+
+  bitset expected(3000, value);
+  expected.flip(0).set(1500).reset(2999);
+  CHECK(bs.count() == expected.count());
+  CHECK(bs.snapshot() == expected);
+
+  bs.modify(1, [](bitset::view shard) { shard.subview(0, 10).flip(); });
+  expected.flip(1024, 1034);
+  CHECK(bs.count() == expected.count());
+  CHECK(bs.snapshot() == expected);
+  CHECK(bs.read(1, [](bitset::const_view shard) { return shard.count(); }) == expected.subview(1024, 1024).count());
+}
+
+TEST_CASE("sharded_bitset concurrent writers") {
+  constexpr std::size_t THREADS = 4;
+  constexpr std::size_t SHARD_SIZE = 4096;
+  sharded_bitset bs(THREADS * SHARD_SIZE, false, SHARD_SIZE);
+
+  std::atomic<bool> stop = false;
+  std::atomic<bool> consistent = true;
+  std::thread reader([&] {
+    std::size_t last = 0;
+    while (!stop) {
+      // Writers only ever add bits, so the observed count can't decrease
+      std::size_t current = bs.count();
+      if (current < last || current > bs.size()) {
+        consistent = false;
+      }
+      last = current;
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (std::size_t t = 0; t < THREADS; ++t) {
+    writers.emplace_back([&bs, t] {
+      for (std::size_t i = 0; i < SHARD_SIZE; i += 2) {
+        bs.set(t * SHARD_SIZE + i);
+      }
+      bs.modify(t, [](bitset::view shard) { shard.subview(0, 100).set(); });
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  stop = true;
+  reader.join();
+
+  CHECK(consistent);
+  CHECK(bs.count() == THREADS * (SHARD_SIZE / 2 + 50));
+  CHECK(bs.snapshot().count() == bs.count());
+}
@@ -0,0 +1,33 @@
+#include "bitset-stats.h"
+#include "bitset.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("bitset stats") {
+  reset_bitset_stats();
+  bitset a(1000, true);
+  bitset b(1000, false);
+  a &= b;
+  a.subview(3, 995) |= b.subview(5, 995);
+  bitset c = a;
+  CHECK(c.count() == 0);
+
+  bitset_stats stats = get_bitset_stats();
+#ifdef BITSET_ENABLE_STATS
+  CHECK(stats.binary_ops >= 2);
+  CHECK(stats.aligned_binary_ops >= 1);
+  CHECK(stats.misaligned_binary_ops >= 1);
+  CHECK(stats.binary_ops == stats.aligned_binary_ops + stats.misaligned_binary_ops);
+  CHECK(stats.binary_bits >= 1995);
+  CHECK(stats.unary_ops >= 1);
+  CHECK(stats.allocations >= 3);
+  CHECK(stats.allocated_bytes >= 3 * 1000 / 8);
+  CHECK(stats.range_copies >= 1);
+  CHECK(stats.copied_bits >= 1000);
+
+  reset_bitset_stats();
+  CHECK(get_bitset_stats() == bitset_stats());
+#else
+  CHECK(stats == bitset_stats());
+#endif
+}
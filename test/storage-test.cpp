@@ -0,0 +1,141 @@
+#include "bitset-storage.h"
+#include "bitset.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+bool is_aligned(const void* ptr, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+} // namespace
+
+TEST_CASE("bitset allocation policy") {
+  bitset_allocation_policy saved = get_bitset_allocation_policy();
+  CHECK(saved.alignment == 64);
+
+  SECTION("alignment") {
+    uint64_t* data = allocate_bitset_words(3);
+    CHECK(is_aligned(data, 64));
+    deallocate_bitset_words(data, 3);
+
+    set_bitset_allocation_policy({256, 0, false});
+    data = allocate_bitset_words(5);
+    CHECK(is_aligned(data, 256));
+    set_bitset_allocation_policy(saved);
+    // Released with the policy changed in between
+    deallocate_bitset_words(data, 5);
+  }
+
+  SECTION("huge pages and prefault") {
+    set_bitset_allocation_policy({64, 1 << 16, true});
+    uint64_t* small = allocate_bitset_words(16);
+    uint64_t* large = allocate_bitset_words(1 << 14);
+    CHECK(is_aligned(large, 64));
+    large[(1 << 14) - 1] = 42;
+    CHECK(large[(1 << 14) - 1] == 42);
+    deallocate_bitset_words(small, 16);
+    deallocate_bitset_words(large, 1 << 14);
+
+    // Mapped from the OS, aligned by trimming the mapping
+    std::size_t mapped_count = bitset_allocation_policy::HUGE_PAGE_SIZE / sizeof(uint64_t) + 3;
+    uint64_t* mapped = allocate_bitset_words(mapped_count, true);
+    CHECK(is_aligned(mapped, bitset_allocation_policy::HUGE_PAGE_SIZE));
+    CHECK(std::all_of(mapped, mapped + mapped_count, [](uint64_t word) { return word == 0; }));
+    deallocate_bitset_words(mapped, mapped_count);
+
+    bitset bs(1 << 20, true);
+    CHECK(bs.count() == 1 << 20);
+    set_bitset_allocation_policy(saved);
+  }
+
+  SECTION("huge page threshold below a huge page") {
+    // Allocations between the threshold and a huge page are not padded to a whole huge page
+    set_bitset_allocation_policy({64, 1 << 12, false});
+    std::size_t count = (1 << 16) / sizeof(uint64_t);
+    uint64_t* data = allocate_bitset_words(count);
+    CHECK(is_aligned(data, 64));
+#if defined(__GLIBC__)
+    CHECK(malloc_usable_size(data) < bitset_allocation_policy::HUGE_PAGE_SIZE);
+#endif
+    deallocate_bitset_words(data, count);
+
+    bitset bs((1 << 16) * 8, true);
+    CHECK(bs.all());
+    set_bitset_allocation_policy(saved);
+  }
+
+  SECTION("zeroed") {
+    for (std::size_t count : {std::size_t(1), std::size_t(100), bitset_allocation_policy::MAP_THRESHOLD / 8 * 3}) {
+      uint64_t* data = allocate_bitset_words(count, true);
+      CHECK(is_aligned(data, 64));
+      CHECK(std::all_of(data, data + count, [](uint64_t word) { return word == 0; }));
+      data[count - 1] = 1;
+      deallocate_bitset_words(data, count);
+    }
+  }
+
+  CHECK(get_bitset_allocation_policy().alignment == saved.alignment);
+}
+
+TEST_CASE("bitset allocation policy benchmark", "[!benchmark]") {
+  constexpr std::size_t SIZE = std::size_t(1) << 32;
+  bitset_allocation_policy saved = get_bitset_allocation_policy();
+  bitset_allocation_policy policy = saved;
+  SECTION("16-byte alignment") {
+    policy.alignment = 16;
+  }
+  SECTION("cache-line alignment") {
+    policy.alignment = 64;
+  }
+  SECTION("huge pages") {
+    policy.huge_page_threshold = bitset_allocation_policy::HUGE_PAGE_SIZE;
+  }
+  SECTION("huge pages, prefaulted") {
+    policy.huge_page_threshold = bitset_allocation_policy::HUGE_PAGE_SIZE;
+    policy.prefault = true;
+  }
+  set_bitset_allocation_policy(policy);
+
+  std::mt19937_64 rng(41);
+  std::uniform_int_distribution<std::size_t> position(0, SIZE - 1);
+  std::vector<std::size_t> positions(1 << 20);
+  for (std::size_t& pos : positions) {
+    pos = position(rng);
+  }
+
+  BENCHMARK("construction") {
+    return bitset(SIZE, true);
+  };
+  bitset bs(SIZE, false);
+  for (std::size_t pos : positions) {
+    bs.set(pos);
+  }
+  BENCHMARK("random access") {
+    std::size_t res = 0;
+    for (std::size_t pos : positions) {
+      res += bs.test(pos);
+    }
+    return res;
+  };
+  BENCHMARK("streaming count") {
+    return bs.count();
+  };
+  bitset ones(SIZE, true);
+  BENCHMARK("streaming and") {
+    bs &= ones;
+  };
+
+  set_bitset_allocation_policy(saved);
+}
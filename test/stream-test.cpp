@@ -0,0 +1,123 @@
+#include "bitset-stream.h"
+#include "test-helpers.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+bitset read_all(const std::string& path, std::size_t window_size) {
+  bitset res;
+  bitset_stream_reader reader(path, window_size);
+  while (reader.next()) {
+    CHECK(reader.position() == res.size());
+    CHECK(reader.window().size() <= window_size);
+    res.insert(res.size(), reader.window());
+  }
+  CHECK_FALSE(reader.next());
+  return res;
+}
+
+} // namespace
+
+TEST_CASE("bitset stream round trip") {
+  std::size_t size = GENERATE(0, 1, 63, 64, 65, 1000, 4096, 100000);
+  auto mode = GENERATE(bitset_stream_writer::io_mode::buffered, bitset_stream_writer::io_mode::direct);
+  std::mt19937 rng(static_cast<unsigned>(size));
+  bitset expected = random_bitset(size, rng, 0.3);
+  std::string path = temp_path("stream-round-trip");
+
+  {
+    bitset_stream_writer writer(path, mode);
+    // Mix all the ways of appending
+    std::size_t pos = 0;
+    while (pos < size) {
+      std::size_t chunk = std::min<std::size_t>(size - pos, rng() % 150);
+      if (chunk == 1) {
+        writer.push_back(expected[pos]);
+      } else if (chunk <= 64) {
+        writer.append_word(expected.subview(pos, chunk).read_word(0, chunk), chunk);
+      } else {
+        writer.append(expected.subview(pos, chunk));
+      }
+      pos += chunk;
+    }
+    CHECK(writer.size() == size);
+    writer.close();
+  }
+  CHECK(std::filesystem::file_size(path) == (size + 63) / 64 * 8 + 8);
+
+  for (std::size_t window_size : {64, 192, 4096}) {
+    CHECK(read_all(path, window_size) == expected);
+  }
+
+  std::size_t count = 0;
+  {
+    bitset_stream_reader reader(path, 128);
+    while (reader.next()) {
+      count += reader.window().count();
+    }
+  }
+  CHECK(count == expected.count());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("bitset stream errors") {
+  std::string path = temp_path("stream-errors");
+  {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    // 16 bytes of data, but the size says 300 bits
+    unsigned char bytes[24] = {};
+    bytes[16] = 300 % 256;
+    bytes[17] = 300 / 256;
+    std::fwrite(bytes, 1, sizeof(bytes), file);
+    std::fclose(file);
+  }
+  {
+    bitset_stream_reader reader(path, 64);
+    CHECK_THROWS_AS([&] { while (reader.next()) {} }(), std::invalid_argument);
+  }
+  {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    std::fwrite("abc", 1, 3, file);
+    std::fclose(file);
+  }
+  {
+    bitset_stream_reader reader(path, 64);
+    CHECK_THROWS_AS(reader.next(), std::invalid_argument);
+  }
+  std::filesystem::remove(path);
+
+  CHECK_THROWS_AS(bitset_stream_reader(temp_path("stream-missing/file"), 64), std::system_error);
+}
+
+#if defined(__linux__)
+TEST_CASE("bitset stream writer closes the file on write errors") {
+  auto open_files = [] {
+    auto entries = std::filesystem::directory_iterator("/proc/self/fd");
+    return std::distance(begin(entries), end(entries));
+  };
+  auto mode = GENERATE(bitset_stream_writer::io_mode::buffered, bitset_stream_writer::io_mode::direct);
+
+  auto before = open_files();
+  {
+    // Every write to `/dev/full` fails with `ENOSPC`
+    bitset_stream_writer writer("/dev/full", mode);
+    writer.append(bitset(1000, true));
+    CHECK(open_files() == before + 1);
+    CHECK_THROWS_AS(writer.close(), std::system_error);
+    CHECK(open_files() == before);
+    CHECK_NOTHROW(writer.close());
+  }
+  CHECK(open_files() == before);
+}
+#endif
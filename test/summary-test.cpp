@@ -0,0 +1,123 @@
+#include "summary-bitset.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+bitset make_sparse(std::size_t size, std::size_t ones, std::mt19937& rng) {
+  bitset bs(size, false);
+  std::uniform_int_distribution<std::size_t> pos(0, size - 1);
+  for (std::size_t i = 0; i < ones; ++i) {
+    bs.set(pos(rng));
+  }
+  return bs;
+}
+
+void check_same(const summary_bitset& bs, const bitset& expected) {
+  REQUIRE(bs.bits() == expected);
+  REQUIRE(bs.any() == expected.any());
+  REQUIRE(bs.count() == expected.count());
+
+  std::vector<std::size_t> positions;
+  bs.for_each([&positions](std::size_t pos) { positions.push_back(pos); });
+  std::vector<std::size_t> expected_positions;
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    if (expected[i]) {
+      expected_positions.push_back(i);
+    }
+  }
+  REQUIRE(positions == expected_positions);
+}
+
+} // namespace
+
+TEST_CASE("bitset find_first/find_next") {
+  bitset bs(300, false);
+  CHECK(bs.find_first() == bitset::npos);
+
+  bs.set(5).set(64).set(299);
+  CHECK(bs.find_first() == 5);
+  CHECK(bs.find_next(5) == 5);
+  CHECK(bs.find_next(6) == 64);
+  CHECK(bs.find_next(65) == 299);
+  CHECK(bs.find_next(300) == bitset::npos);
+  CHECK(bs.subview(6).find_first() == 58);
+}
+
+TEST_CASE("summary_bitset") {
+  std::size_t size = GENERATE(10, 64, 65, 5000, 300000);
+  CAPTURE(size);
+
+  std::mt19937 rng(size);
+  bitset expected = make_sparse(size, 20, rng);
+  summary_bitset bs(expected);
+  check_same(bs, expected);
+  CHECK(bs.level_count() == (size <= 64 ? 1 : size <= 4096 ? 2 : size <= 262144 ? 3 : 4));
+
+  SECTION("single bit updates") {
+    std::uniform_int_distribution<std::size_t> pos(0, size - 1);
+    for (int i = 0; i < 50; ++i) {
+      std::size_t p = pos(rng);
+      switch (i % 3) {
+      case 0:
+        bs.set(p);
+        expected.set(p);
+        break;
+      case 1:
+        bs.flip(p);
+        expected.flip(p);
+        break;
+      default:
+        std::size_t q = expected.find_first();
+        if (q != bitset::npos) {
+          bs.reset(q);
+          expected.reset(q);
+        }
+        break;
+      }
+    }
+    check_same(bs, expected);
+
+    while (expected.any()) {
+      std::size_t q = expected.find_first();
+      bs.reset(q);
+      expected.reset(q);
+    }
+    check_same(bs, expected);
+    CHECK_FALSE(bs.any());
+  }
+
+  SECTION("ranges") {
+    bs.set(size / 3, size / 2, true);
+    expected.set(size / 3, size / 2, true);
+    check_same(bs, expected);
+
+    bs.reset(0, size - 1);
+    expected.reset(0, size - 1);
+    check_same(bs, expected);
+  }
+
+  SECTION("binary operations") {
+    bitset other_bits = make_sparse(size, 20, rng);
+    other_bits |= expected.subview(0, size / 2) << (size - size / 2);
+    summary_bitset other(other_bits);
+
+    bs |= other;
+    expected |= other_bits;
+    check_same(bs, expected);
+
+    bs ^= other;
+    expected ^= other_bits;
+    check_same(bs, expected);
+
+    bs |= summary_bitset(make_sparse(size, 10, rng));
+    expected = bs.bits();
+    bs &= other;
+    expected &= other_bits;
+    check_same(bs, expected);
+  }
+}
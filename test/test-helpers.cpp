@@ -1,5 +1,6 @@
 #include "test-helpers.h"
 
+#include <filesystem>
 #include <ranges>
 
 std::vector<bool> string_to_bools(std::string_view str) {
@@ -7,6 +8,10 @@ std::vector<bool> string_to_bools(std::string_view str) {
   return {view.begin(), view.end()};
 }
 
+std::string temp_path(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / ("bitset-test-" + name)).string();
+}
+
 bitset_equals_string::bitset_equals_string(std::string_view expected)
     : _expected(expected) {}
 
@@ -4,10 +4,28 @@
 
 #include <catch2/matchers/catch_matchers.hpp>
 
+#include <random>
+#include <string>
 #include <vector>
 
 std::vector<bool> string_to_bools(std::string_view str);
 
+// Every bit set independently with probability `density`
+template <class Generator>
+bitset random_bitset(std::size_t size, Generator& rng, double density = 0.5) {
+  bitset res(size, false);
+  std::bernoulli_distribution bit(density);
+  for (std::size_t i = 0; i < size; ++i) {
+    if (bit(rng)) {
+      res.set(i);
+    }
+  }
+  return res;
+}
+
+// Path of a scratch file `name` in the system temporary directory
+std::string temp_path(const std::string& name);
+
 struct bitset_equals_string : Catch::Matchers::MatcherBase<bitset> {
   explicit bitset_equals_string(std::string_view expected);
 